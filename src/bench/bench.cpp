@@ -0,0 +1,285 @@
+/**
+ * @file bench.cpp
+ * @author David Xu
+ * @brief End-to-end benchmark harness timing boo commands on synthetic trees
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+
+#include "../include/cxxopts.hpp"
+#include "bench_utils.h"
+#include "repo_gen.h"
+
+using namespace std;
+using namespace boo::bench;
+namespace fs = std::filesystem;
+
+/**
+ * @brief a scale to benchmark at
+ *
+ */
+struct scale_t {
+    u64 files;
+    u64 commits;
+};
+
+/**
+ * @brief Runs boo in a directory with its output discarded
+ *
+ * @param boo the boo binary
+ * @param dir the working directory
+ * @param args the arguments after the binary name
+ * @param result the result to add the wall time and peak RSS to
+ * @return true if boo exited with status 0
+ */
+static bool run_boo(const string& boo, const fs::path& dir,
+                    vector<string> args, bench_result_t* result) {
+    auto start = chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid == 0) {
+        if (chdir(dir.c_str())) _exit(127);
+        int devnull = open("/dev/null", O_WRONLY);
+        dup2(devnull, STDOUT_FILENO);
+        dup2(devnull, STDERR_FILENO);
+
+        vector<char*> argv{(char*)boo.c_str()};
+        for (auto& arg : args) argv.push_back(arg.data());
+        argv.push_back(nullptr);
+        execv(boo.c_str(), argv.data());
+        _exit(127);
+    }
+
+    int status = 0;
+    rusage usage;
+    wait4(pid, &status, 0, &usage);
+    double seconds =
+        chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    if (result) {
+        result->seconds.push_back(seconds);
+        auto& rss = result->metrics["peak_rss_kb"];
+        rss = max(rss, (double)usage.ru_maxrss);
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+static string read_head(const fs::path& dir) {
+    ifstream head(dir / ".boo" / "head");
+    string commit;
+    head >> commit;
+    return commit;
+}
+
+static string scale_name(u64 n) {
+    if (n >= 1000000 && n % 1000000 == 0) return to_string(n / 1000000) + "M";
+    if (n >= 1000 && n % 1000 == 0) return to_string(n / 1000) + "k";
+    return to_string(n);
+}
+
+/**
+ * @brief Builds a history at one scale and times each command on it
+ *
+ */
+static void run_scale(const string& boo, const fs::path& work_dir,
+                      repo_params_t params, scale_t scale, int repeat,
+                      vector<bench_result_t>& results) {
+    params.file_count = scale.files;
+    string prefix =
+        scale_name(scale.files) + "_files_" + scale_name(scale.commits) +
+        "_commits/";
+    fs::path dir = work_dir / prefix;
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+
+    cerr << "[" << prefix << "] generating " << scale.files << " files"
+         << endl;
+    repo_generator gen(dir, params);
+    u64 bytes = gen.generate();
+
+    bench_result_t init(prefix + "init");
+    run_boo(boo, dir, {"init"}, &init);
+
+    bench_result_t first_commit(prefix + "commit_initial");
+    first_commit.metrics["tree_bytes"] = bytes;
+    run_boo(boo, dir, {"commit", "-m", "initial"}, &first_commit);
+    string first = read_head(dir);
+
+    cerr << "[" << prefix << "] building " << scale.commits << " commits"
+         << endl;
+    bench_result_t commit(prefix + "commit");
+    for (u64 i = 1; i < scale.commits; ++i) {
+        gen.mutate();
+        run_boo(boo, dir, {"commit", "-m", "commit " + to_string(i)}, &commit);
+    }
+    string last = read_head(dir);
+
+    cerr << "[" << prefix << "] timing status, log and reset" << endl;
+    bench_result_t status_clean(prefix + "status_clean");
+    for (int i = 0; i < repeat; ++i) {
+        run_boo(boo, dir, {"status"}, &status_clean);
+    }
+
+    gen.mutate();
+    bench_result_t status_dirty(prefix + "status_dirty");
+    for (int i = 0; i < repeat; ++i) {
+        run_boo(boo, dir, {"status"}, &status_dirty);
+    }
+
+    bench_result_t log(prefix + "log");
+    for (int i = 0; i < repeat; ++i) run_boo(boo, dir, {"log"}, &log);
+
+    bench_result_t reset(prefix + "reset");
+    for (int i = 0; i < repeat; ++i) {
+        string target = i % 2 ? last : first;
+        run_boo(boo, dir, {"reset", "-f", "-c", target}, &reset);
+    }
+
+    for (auto* r : {&init, &first_commit, &commit, &status_clean,
+                    &status_dirty, &log, &reset}) {
+        r->metrics["files"] = gen.file_count();
+        results.push_back(*r);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    cxxopts::Options options("boo_bench",
+                             "end-to-end benchmarks of boo on synthetic trees");
+    repo_params_t defaults;
+    options.add_options()("boo", "Path to the boo binary",
+                          cxxopts::value<string>()->default_value("bin/boo"))(
+        "preset", "Scales to run: small, medium, large or all",
+        cxxopts::value<string>()->default_value("small"))(
+        "scales", "Comma separated files:commits pairs (overrides --preset)",
+        cxxopts::value<string>())(
+        "depth", "Directory depth",
+        cxxopts::value<int>()->default_value(to_string(defaults.depth)))(
+        "fanout", "Subdirectories per directory",
+        cxxopts::value<int>()->default_value(to_string(defaults.fanout)))(
+        "size-dist", "File size distribution: fixed, uniform or lognormal",
+        cxxopts::value<string>()->default_value(defaults.size_dist))(
+        "min-size", "Minimum file size",
+        cxxopts::value<u64>()->default_value(to_string(defaults.min_size)))(
+        "max-size", "Maximum file size",
+        cxxopts::value<u64>()->default_value(to_string(defaults.max_size)))(
+        "median-size", "Median (or fixed) file size",
+        cxxopts::value<u64>()->default_value(to_string(defaults.median_size)))(
+        "sigma", "Lognormal shape parameter",
+        cxxopts::value<double>()->default_value(to_string(defaults.sigma)))(
+        "change-ratio", "Fraction of files changed between commits",
+        cxxopts::value<double>()->default_value(
+            to_string(defaults.change_ratio)))(
+        "seed", "Generator seed",
+        cxxopts::value<u64>()->default_value(to_string(defaults.seed)))(
+        "repeat", "Runs of each status, log and reset measurement",
+        cxxopts::value<int>()->default_value("5"))(
+        "dir", "Directory to build the trees in (in a new subdirectory)",
+        cxxopts::value<string>()->default_value(
+            fs::temp_directory_path().string()))(
+        "keep", "Keep the generated trees")(
+        "o, output", "Write JSON results to a file instead of stdout",
+        cxxopts::value<string>())(
+        "baseline", "Compare against results saved from a previous run",
+        cxxopts::value<string>())(
+        "threshold", "Relative slowdown reported as a regression",
+        cxxopts::value<double>()->default_value("0.1"))("h, help",
+                                                        "Print usage");
+
+    auto result = options.parse(argc, argv);
+    if (result.count("help")) {
+        cout << options.help() << endl;
+        return 0;
+    }
+
+    string boo = fs::absolute(result["boo"].as<string>()).string();
+    if (!fs::exists(boo)) {
+        cerr << "Could not find boo at " << boo << " (build it or pass --boo)"
+             << endl;
+        return 1;
+    }
+
+    map<string, vector<scale_t>> presets{
+        {"small", {{10000, 100}}},
+        {"medium", {{100000, 1000}}},
+        {"large", {{2000000, 10000}}},
+        {"all", {{10000, 100}, {100000, 1000}, {2000000, 10000}}},
+    };
+    vector<scale_t> scales;
+    if (result.count("scales")) {
+        stringstream list(result["scales"].as<string>());
+        string pair;
+        while (getline(list, pair, ',')) {
+            auto colon = pair.find(':');
+            if (colon == string::npos) {
+                cerr << "Scales must be files:commits pairs" << endl;
+                return 1;
+            }
+            scales.push_back({stoull(pair.substr(0, colon)),
+                              stoull(pair.substr(colon + 1))});
+        }
+    } else if (presets.count(result["preset"].as<string>())) {
+        scales = presets[result["preset"].as<string>()];
+    } else {
+        cerr << "Unknown preset " << result["preset"].as<string>() << endl;
+        return 1;
+    }
+
+    repo_params_t params;
+    params.depth = result["depth"].as<int>();
+    params.fanout = result["fanout"].as<int>();
+    params.size_dist = result["size-dist"].as<string>();
+    params.min_size = result["min-size"].as<u64>();
+    params.max_size = result["max-size"].as<u64>();
+    params.median_size = result["median-size"].as<u64>();
+    params.sigma = result["sigma"].as<double>();
+    params.change_ratio = result["change-ratio"].as<double>();
+    params.seed = result["seed"].as<u64>();
+
+    // only the subdirectory made here is ever removed
+    fs::path work_dir = make_work_dir(result["dir"].as<string>(), "boo-bench");
+    if (work_dir.empty()) {
+        cerr << "Could not create a directory in " << result["dir"].as<string>()
+             << endl;
+        return 1;
+    }
+    vector<bench_result_t> results;
+    for (const auto& scale : scales) {
+        run_scale(boo, work_dir, params, scale, result["repeat"].as<int>(),
+                  results);
+    }
+    if (result.count("keep")) {
+        cerr << "Kept the trees in " << work_dir.string() << endl;
+    } else {
+        fs::remove_all(work_dir);
+    }
+
+    if (result.count("output")) {
+        ofstream out(result["output"].as<string>());
+        write_results(out, "e2e", results);
+    } else {
+        write_results(cout, "e2e", results);
+    }
+
+    if (result.count("baseline")) {
+        auto baseline = load_baseline(result["baseline"].as<string>());
+        if (baseline.empty()) {
+            cerr << "Could not read baseline "
+                 << result["baseline"].as<string>() << endl;
+            return 1;
+        }
+        int regressions = compare_to_baseline(
+            cerr, results, baseline, result["threshold"].as<double>());
+        return regressions ? 2 : 0;
+    }
+    return 0;
+}
@@ -0,0 +1,110 @@
+/**
+ * @file bench_utils.cpp
+ * @author David Xu
+ * @brief Result reporting and baseline comparison shared by the benchmarks
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "bench_utils.h"
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace boo::bench {
+bench_result_t::bench_result_t(string key) : key(key), seconds(), metrics() {}
+
+double bench_result_t::median() const {
+    if (seconds.empty()) return 0;
+    vector<double> sorted = seconds;
+    sort(sorted.begin(), sorted.end());
+    size_t mid = sorted.size() / 2;
+    if (sorted.size() % 2) return sorted[mid];
+    return (sorted[mid - 1] + sorted[mid]) / 2;
+}
+
+double bench_result_t::min() const {
+    return seconds.empty() ? 0 : *min_element(seconds.begin(), seconds.end());
+}
+
+double bench_result_t::max() const {
+    return seconds.empty() ? 0 : *max_element(seconds.begin(), seconds.end());
+}
+
+void write_results(ostream& out, string suite,
+                   const vector<bench_result_t>& results) {
+    out << "{\"suite\":\"" << string_utils::json_escape(suite)
+        << "\",\"results\":[\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        out << "{\"key\":\"" << string_utils::json_escape(r.key)
+            << "\",\"runs\":" << r.seconds.size() << setprecision(9)
+            << ",\"median_s\":" << r.median() << ",\"min_s\":" << r.min()
+            << ",\"max_s\":" << r.max();
+        for (const auto& [name, value] : r.metrics) {
+            out << ",\"" << string_utils::json_escape(name) << "\":" << value;
+        }
+        out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "]}" << endl;
+}
+
+map<string, double> load_baseline(string path) {
+    map<string, double> baseline;
+    ifstream in(path);
+    string line;
+    while (getline(in, line)) {
+        // write_results puts every result on its own line
+        auto key_pos = line.find("{\"key\":\"");
+        auto median_pos = line.find("\"median_s\":");
+        if (key_pos == string::npos || median_pos == string::npos) continue;
+
+        key_pos += 8;
+        auto key_end = line.find('"', key_pos);
+        baseline[line.substr(key_pos, key_end - key_pos)] =
+            stod(line.substr(median_pos + 11));
+    }
+    return baseline;
+}
+
+int compare_to_baseline(ostream& out, const vector<bench_result_t>& results,
+                        const map<string, double>& baseline,
+                        double threshold) {
+    int regressions = 0;
+    out << left << setw(48) << "benchmark" << right << setw(14) << "baseline"
+        << setw(14) << "current" << setw(10) << "change" << endl;
+    for (const auto& r : results) {
+        auto itr = baseline.find(r.key);
+        if (itr == baseline.end() || itr->second <= 0) {
+            out << left << setw(48) << r.key << right << setw(14) << "-"
+                << setw(14) << r.median() << setw(10) << "new" << endl;
+            continue;
+        }
+
+        double change = r.median() / itr->second - 1.0;
+        bool regressed = change > threshold;
+        regressions += regressed;
+        out << left << setw(48) << r.key << right << setw(14) << itr->second
+            << setw(14) << r.median() << setw(9) << fixed << setprecision(1)
+            << change * 100 << "%" << defaultfloat << setprecision(6)
+            << (regressed ? "  REGRESSION" : "") << endl;
+    }
+    return regressions;
+}
+
+fs::path make_work_dir(const fs::path& parent, const string& name) {
+    error_code ec;
+    fs::create_directories(parent, ec);
+    string pattern = (parent / (name + "-XXXXXX")).string();
+    if (!mkdtemp(pattern.data())) return {};
+    return pattern;
+}
+}  // namespace boo::bench
@@ -0,0 +1,80 @@
+/**
+ * @file bench_utils.h
+ * @author David Xu
+ * @brief Result reporting and baseline comparison shared by the benchmarks
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../utils/utils.h"
+
+namespace boo::bench {
+/**
+ * @brief the timings of one benchmark
+ *
+ */
+struct bench_result_t {
+    std::string key;  // unique within a suite, used to match baselines
+    std::vector<double> seconds;
+    std::map<std::string, double> metrics;  // extra named measurements
+
+    bench_result_t(std::string key);
+    double median() const;
+    double min() const;
+    double max() const;
+};
+
+/**
+ * @brief Writes results as JSON, one result object per line
+ *
+ * @param out the stream to write to
+ * @param suite the name of the suite
+ * @param results the results
+ */
+void write_results(std::ostream& out, std::string suite,
+                   const std::vector<bench_result_t>& results);
+
+/**
+ * @brief Loads the median timings from a file written by write_results
+ *
+ * @param path the baseline file
+ * @return std::map<std::string, double> key to median seconds (empty if the
+ * file could not be read)
+ */
+std::map<std::string, double> load_baseline(std::string path);
+
+/**
+ * @brief Prints how each result compares to the baseline
+ *
+ * @param out the stream to print to
+ * @param results the new results
+ * @param baseline the baseline medians
+ * @param threshold relative slowdown counted as a regression (0.1 = 10%)
+ * @return int the number of regressions
+ */
+int compare_to_baseline(std::ostream& out,
+                        const std::vector<bench_result_t>& results,
+                        const std::map<std::string, double>& baseline,
+                        double threshold);
+
+/**
+ * @brief Creates a new, uniquely named directory to work in, so a run never
+ * touches (or removes) anything already in the directory it was given
+ *
+ * @param parent where to create it (created too if missing)
+ * @param name the start of its name
+ * @return std::filesystem::path the directory, empty if it could not be
+ * created
+ */
+std::filesystem::path make_work_dir(const std::filesystem::path& parent,
+                                    const std::string& name);
+}  // namespace boo::bench
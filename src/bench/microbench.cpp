@@ -0,0 +1,315 @@
+/**
+ * @file microbench.cpp
+ * @author David Xu
+ * @brief Microbenchmarks for the hashing kernels and file reading strategies
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <sstream>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#endif
+
+#include "../include/cxxopts.hpp"
+#include "../utils/fast_hash.h"
+#include "../utils/sha.h"
+#include "bench_utils.h"
+#include "repo_gen.h"
+
+using namespace std;
+using namespace boo;
+using namespace boo::bench;
+namespace fs = std::filesystem;
+
+/**
+ * @brief a hashing kernel under test
+ *
+ */
+struct hash_kernel_t {
+    string name;
+    function<u64(const string&)> hash;
+};
+
+static const vector<hash_kernel_t> kernels{
+    {"sha_obj",
+     [](const string& data) {
+         sha_obj sha;
+         sha.update(data);
+         return sha.get_hash();
+     }},
+    {"fast_hash",
+     // what change detection uses
+     [](const string& data) { return fast_hash(data.data(), data.size()); }},
+};
+
+/**
+ * @brief a way of reading a whole file into memory, returning a checksum of
+ * the bytes so every page is actually touched
+ *
+ */
+struct read_strategy_t {
+    string name;
+    function<u64(const fs::path&)> read;
+};
+
+static u64 checksum(const char* data, size_t size) {
+    u64 sum = 0;
+    for (size_t i = 0; i < size; i += 64) sum += (unsigned char)data[i];
+    return sum;
+}
+
+static const vector<read_strategy_t> read_strategies{
+    {"ifstream",
+     // what calculate_current_hashes does
+     [](const fs::path& path) {
+         ifstream file(path);
+         stringstream buffer;
+         buffer << file.rdbuf();
+         string contents = buffer.str();
+         return checksum(contents.data(), contents.size());
+     }},
+    {"read",
+     [](const fs::path& path) {
+         int fd = open(path.c_str(), O_RDONLY);
+         struct stat st;
+         fstat(fd, &st);
+         string contents(st.st_size, '\0');
+         size_t done = 0;
+         while (done < contents.size()) {
+             ssize_t n =
+                 read(fd, contents.data() + done, contents.size() - done);
+             if (n <= 0) break;
+             done += n;
+         }
+         close(fd);
+         return checksum(contents.data(), done);
+     }},
+    {"mmap",
+     [](const fs::path& path) {
+         int fd = open(path.c_str(), O_RDONLY);
+         struct stat st;
+         fstat(fd, &st);
+         u64 sum = 0;
+         if (st.st_size) {
+             void* data =
+                 mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+             madvise(data, st.st_size, MADV_SEQUENTIAL);
+             sum = checksum((const char*)data, st.st_size);
+             munmap(data, st.st_size);
+         }
+         close(fd);
+         return sum;
+     }},
+};
+
+static u64 cycles() {
+#ifdef HAVE_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/* parses sizes like 64, 4K, 1M, 1G */
+static vector<u64> parse_sizes(string list) {
+    vector<u64> sizes;
+    stringstream in(list);
+    string item;
+    while (getline(in, item, ',')) {
+        u64 size = stoull(item);
+        switch (toupper(item.back())) {
+            case 'G':
+                size <<= 10;
+                [[fallthrough]];
+            case 'M':
+                size <<= 10;
+                [[fallthrough]];
+            case 'K':
+                size <<= 10;
+        }
+        sizes.push_back(size);
+    }
+    return sizes;
+}
+
+static string size_name(u64 size) {
+    const char* units[] = {"B", "K", "M", "G"};
+    int unit = 0;
+    while (unit < 3 && size >= 1024 && size % 1024 == 0) {
+        size /= 1024;
+        ++unit;
+    }
+    return to_string(size) + units[unit];
+}
+
+/**
+ * @brief Times fn until at least target_bytes have been processed (and at
+ * least min_runs times), recording GB/s and cycles/byte
+ *
+ */
+static bench_result_t measure(string key, u64 bytes, u64 target_bytes,
+                              int min_runs, function<void()> before,
+                              function<u64()> fn) {
+    bench_result_t result(key);
+    u64 runs = max<u64>(min_runs, target_bytes / max<u64>(bytes, 1));
+    u64 total_cycles = 0;
+    u64 sink = 0;
+    for (u64 i = 0; i < runs; ++i) {
+        if (before) before();
+        auto start = chrono::steady_clock::now();
+        u64 start_cycles = cycles();
+        sink += fn();
+        total_cycles += cycles() - start_cycles;
+        result.seconds.push_back(
+            chrono::duration<double>(chrono::steady_clock::now() - start)
+                .count());
+    }
+
+    result.metrics["bytes"] = bytes;
+    result.metrics["gb_per_s"] = bytes / result.median() / 1e9;
+    if (total_cycles) {
+        result.metrics["cycles_per_byte"] =
+            (double)total_cycles / runs / max<u64>(bytes, 1);
+    }
+    // keeps the work from being optimized away
+    result.metrics["checksum"] = sink % 1000;
+    return result;
+}
+
+/* evicts a file from the page cache (best effort, clean pages only) */
+static void evict(const fs::path& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+int main(int argc, char* argv[]) {
+    cxxopts::Options options("boo_microbench",
+                             "hashing and file reading microbenchmarks");
+    options.add_options()(
+        "sizes", "Hash input sizes",
+        cxxopts::value<string>()->default_value("64,1K,64K,1M,16M,256M,1G"))(
+        "read-sizes", "File sizes for the read strategies",
+        cxxopts::value<string>()->default_value("4K,1M,64M"))(
+        "max-size", "Skip sizes above this many bytes",
+        cxxopts::value<string>()->default_value("1G"))(
+        "target", "Bytes to process per benchmark (more runs on small inputs)",
+        cxxopts::value<string>()->default_value("256M"))(
+        "filter", "Only run benchmarks whose key contains this string",
+        cxxopts::value<string>()->default_value(""))(
+        "dir", "Directory for the read benchmark files (in a new subdirectory)",
+        cxxopts::value<string>()->default_value(
+            fs::temp_directory_path().string()))(
+        "o, output", "Write JSON results to a file instead of stdout",
+        cxxopts::value<string>())(
+        "baseline", "Compare against results saved from a previous run",
+        cxxopts::value<string>())(
+        "threshold", "Relative slowdown reported as a regression",
+        cxxopts::value<double>()->default_value("0.1"))("h, help",
+                                                        "Print usage");
+
+    auto result = options.parse(argc, argv);
+    if (result.count("help")) {
+        cout << options.help() << endl;
+        return 0;
+    }
+
+    u64 max_size = parse_sizes(result["max-size"].as<string>())[0];
+    u64 target = parse_sizes(result["target"].as<string>())[0];
+    string filter = result["filter"].as<string>();
+    auto selected = [&](const string& key) {
+        return key.find(filter) != string::npos;
+    };
+    rng_t rng(42);
+    vector<bench_result_t> results;
+
+    for (u64 size : parse_sizes(result["sizes"].as<string>())) {
+        if (size > max_size) continue;
+        string data(size, '\0');
+        for (auto& c : data) c = rng.next();
+
+        for (const auto& kernel : kernels) {
+            string key = "hash/" + kernel.name + "/" + size_name(size);
+            if (!selected(key)) continue;
+            cerr << key << endl;
+            results.push_back(measure(key, size, target, 3, nullptr,
+                                      [&] { return kernel.hash(data); }));
+        }
+    }
+
+    // only the subdirectory made here is ever removed
+    fs::path dir = make_work_dir(result["dir"].as<string>(), "boo-microbench");
+    if (dir.empty()) {
+        cerr << "Could not create a directory in " << result["dir"].as<string>()
+             << endl;
+        return 1;
+    }
+    for (u64 size : parse_sizes(result["read-sizes"].as<string>())) {
+        if (size > max_size) continue;
+        fs::path path = dir / ("read_" + size_name(size));
+        {
+            string data(size, '\0');
+            for (auto& c : data) c = rng.next();
+            ofstream out(path, ios::binary | ios::trunc);
+            out.write(data.data(), data.size());
+        }
+
+        for (const auto& strategy : read_strategies) {
+            string hot_key =
+                "read/" + strategy.name + "/hot/" + size_name(size);
+            if (selected(hot_key)) {
+                cerr << hot_key << endl;
+                strategy.read(path);  // warm the page cache
+                results.push_back(
+                    measure(hot_key, size, target, 3, nullptr,
+                            [&] { return strategy.read(path); }));
+            }
+
+            string cold_key =
+                "read/" + strategy.name + "/cold/" + size_name(size);
+            if (selected(cold_key)) {
+                cerr << cold_key << endl;
+                // cold reads hit the disk, so keep the run count small
+                results.push_back(
+                    measure(cold_key, size, 0, 3, [&] { evict(path); },
+                            [&] { return strategy.read(path); }));
+            }
+        }
+    }
+    fs::remove_all(dir);
+
+    if (result.count("output")) {
+        ofstream out(result["output"].as<string>());
+        write_results(out, "micro", results);
+    } else {
+        write_results(cout, "micro", results);
+    }
+
+    if (result.count("baseline")) {
+        auto baseline = load_baseline(result["baseline"].as<string>());
+        if (baseline.empty()) {
+            cerr << "Could not read baseline "
+                 << result["baseline"].as<string>() << endl;
+            return 1;
+        }
+        int regressions = compare_to_baseline(
+            cerr, results, baseline, result["threshold"].as<double>());
+        return regressions ? 2 : 0;
+    }
+    return 0;
+}
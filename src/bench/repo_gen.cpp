@@ -0,0 +1,105 @@
+/**
+ * @file repo_gen.cpp
+ * @author David Xu
+ * @brief Reproducible synthetic working trees for benchmarking
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "repo_gen.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+using namespace std;
+
+namespace boo::bench {
+u64 rng_t::next() {
+    u64 z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+u64 rng_t::below(u64 bound) { return bound ? next() % bound : 0; }
+
+double rng_t::unit() { return (next() >> 11) * 0x1.0p-53; }
+
+repo_generator::repo_generator(filesystem::path root, repo_params_t params)
+    : root(root), params(params), rng(params.seed), next_id(0), files() {}
+
+filesystem::path repo_generator::new_file_path() {
+    filesystem::path path = root;
+    for (int level = 0; level < params.depth; ++level) {
+        path /= "d" + to_string(rng.below(params.fanout));
+    }
+    return path / ("f" + to_string(next_id++) + ".txt");
+}
+
+u64 repo_generator::pick_size() {
+    u64 size = params.median_size;
+    if (params.size_dist == "uniform") {
+        size = params.min_size +
+               rng.below(params.max_size - params.min_size + 1);
+    } else if (params.size_dist == "lognormal") {
+        // Box-Muller
+        double u1 = 1.0 - rng.unit();
+        double u2 = rng.unit();
+        double normal = sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+        size = (u64)(params.median_size * exp(params.sigma * normal));
+    }
+    return clamp(size, params.min_size, params.max_size);
+}
+
+u64 repo_generator::write_file(const filesystem::path& path, u64 size) {
+    static const char alphabet[] = "abcdefghijklmnopqrstuvwxyz0123456789 ";
+
+    string content(size, '\n');
+    u64 bits = 0;
+    for (u64 i = 0; i < size; ++i) {
+        if (i % 8 == 0) bits = rng.next();
+        // roughly 64 character lines so the content looks like text
+        if (bits % 64 != 0) {
+            content[i] = alphabet[(bits & 0xff) % (sizeof(alphabet) - 1)];
+        }
+        bits >>= 8;
+    }
+
+    filesystem::create_directories(path.parent_path());
+    ofstream out(path, ios::trunc | ios::binary);
+    out.write(content.data(), content.size());
+    return size;
+}
+
+u64 repo_generator::generate() {
+    u64 bytes = 0;
+    files.reserve(params.file_count);
+    for (u64 i = 0; i < params.file_count; ++i) {
+        files.push_back(new_file_path());
+        bytes += write_file(files.back(), pick_size());
+    }
+    return bytes;
+}
+
+u64 repo_generator::mutate() {
+    u64 touched = max<u64>(1, (u64)(files.size() * params.change_ratio));
+    for (u64 i = 0; i < touched; ++i) {
+        u64 action = rng.below(10);
+        if (action == 0 || files.empty()) {
+            files.push_back(new_file_path());
+            write_file(files.back(), pick_size());
+        } else if (action == 1 && files.size() > 1) {
+            u64 victim = rng.below(files.size());
+            filesystem::remove(files[victim]);
+            files[victim] = files.back();
+            files.pop_back();
+        } else {
+            write_file(files[rng.below(files.size())], pick_size());
+        }
+    }
+    return touched;
+}
+}  // namespace boo::bench
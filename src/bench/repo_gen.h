@@ -0,0 +1,95 @@
+/**
+ * @file repo_gen.h
+ * @author David Xu
+ * @brief Reproducible synthetic working trees for benchmarking
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "../utils/utils.h"
+
+namespace boo::bench {
+/**
+ * @brief splitmix64; used instead of <random> so trees are identical across
+ * standard library implementations
+ *
+ */
+class rng_t {
+   public:
+    rng_t(u64 seed) : state(seed) {}
+    u64 next();
+    /* uniform in [0, bound) */
+    u64 below(u64 bound);
+    /* uniform in [0, 1) */
+    double unit();
+
+   private:
+    u64 state;
+};
+
+/**
+ * @brief the shape of a generated tree
+ *
+ */
+struct repo_params_t {
+    u64 file_count = 10000;
+    int depth = 3;           // directory levels below the root
+    int fanout = 16;         // subdirectories per directory
+    std::string size_dist = "lognormal";  // fixed, uniform or lognormal
+    u64 min_size = 0;
+    u64 max_size = 1 << 20;
+    u64 median_size = 4096;  // fixed size / lognormal median
+    double sigma = 1.5;      // lognormal shape
+    double change_ratio = 0.01;  // fraction of files touched per mutation
+    u64 seed = 42;
+};
+
+/**
+ * @brief Generates and mutates a synthetic working tree. The same params
+ * always produce byte-identical trees and mutation sequences.
+ *
+ */
+class repo_generator {
+   public:
+    repo_generator(std::filesystem::path root, repo_params_t params);
+
+    /**
+     * @brief Writes the initial tree
+     *
+     * @return u64 the number of bytes written
+     */
+    u64 generate();
+
+    /**
+     * @brief Modifies, adds and deletes about change_ratio * file_count
+     * files (80% modifications, 10% additions, 10% deletions)
+     *
+     * @return u64 the number of files touched
+     */
+    u64 mutate();
+
+    /**
+     * @brief The current number of files in the tree
+     *
+     */
+    u64 file_count() const { return files.size(); }
+
+   private:
+    std::filesystem::path new_file_path();
+    u64 pick_size();
+    u64 write_file(const std::filesystem::path& path, u64 size);
+
+    std::filesystem::path root;
+    repo_params_t params;
+    rng_t rng;
+    u64 next_id;
+    std::vector<std::filesystem::path> files;
+};
+}  // namespace boo::bench
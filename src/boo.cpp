@@ -10,6 +10,14 @@
  */
 #include "boo.h"
 
+#include <unistd.h>
+
+#include <iomanip>
+#include <map>
+
+#include "context.h"
+#include "daemon.h"
+
 using namespace boo;
 using namespace std;
 
@@ -18,532 +26,746 @@ using namespace std;
 #define RESET "reset"
 #define LOG "log"
 #define STATUS "status"
-
-#define BOO_DIR ".boo"
-#define LOG_FILE_NAME "log"
-#define META_FILE_NAME "meta"
-#define HEAD_FILE_NAME "head"
+#define DIFF "diff"
+#define GREP "grep"
+#define SHOW "show"
+#define DAEMON "daemon"
+#define BATCH "batch"
+#define CHANGE_DIRECTORY "cd"
 
 namespace boo {
-commit_t::commit_t(string hash, string message)
-    : message(message), hash(hash) {}
-
-BooContext::BooContext() : repo_dir() {}
-
-bool BooContext::load_existing_context() {
-    debug_log("Attempting to load an existing Boo context");
-    using namespace std::filesystem;
-    auto curr_dir = absolute(current_path());
-
-    unordered_set<string> visited;
-
-    while (!visited.count(curr_dir.string())) {
-        debug_log("Searching for boo instances in " + curr_dir.string());
-        if (exists(curr_dir / BOO_DIR) && is_directory(curr_dir / BOO_DIR)) {
-            debug_log("Found a boo instance at " +
-                      (curr_dir / BOO_DIR).string());
-            repo_dir = curr_dir;
+const unordered_set<string> Boo::commands{INIT, COMMIT, RESET, LOG,    STATUS,
+                                          DIFF, GREP,   SHOW,  DAEMON, BATCH};
+const unordered_set<string> Boo::daemon_commands{COMMIT, LOG, STATUS};
+unordered_map<string, string> Boo::command_descriptions{
+    {INIT, "Initializes a repository here"},
+    {COMMIT, "Commits to this repository, if it exists"},
+    {RESET, "Reset to a commit"},
+    {LOG, "See previous commits"},
+    {STATUS, "See current repository status"},
+    {DIFF, "Compare two commits"},
+    {GREP, "Search committed files"},
+    {SHOW, "Print a file as it is in a commit"},
+    {DAEMON, "Serve status, log and commit from a long running process"},
+    {BATCH, "Run commands read from stdin, one per line, in one process"},
+};
 
-            return true;
+Boo::Boo()
+    : command_handlers{
+          {INIT,
+           bind(&Boo::handle_init, this, placeholders::_1, placeholders::_2)},
+          {COMMIT,
+           bind(&Boo::handle_commit, this, placeholders::_1, placeholders::_2)},
+          {RESET,
+           bind(&Boo::handle_reset, this, placeholders::_1, placeholders::_2)},
+          {LOG,
+           bind(&Boo::handle_log, this, placeholders::_1, placeholders::_2)},
+          {STATUS,
+           bind(&Boo::handle_status, this, placeholders::_1, placeholders::_2)},
+          {DIFF,
+           bind(&Boo::handle_diff, this, placeholders::_1, placeholders::_2)},
+          {GREP,
+           bind(&Boo::handle_grep, this, placeholders::_1, placeholders::_2)},
+          {SHOW,
+           bind(&Boo::handle_show, this, placeholders::_1, placeholders::_2)},
+          {DAEMON,
+           bind(&Boo::handle_daemon, this, placeholders::_1, placeholders::_2)},
+          {BATCH,
+           bind(&Boo::handle_batch, this, placeholders::_1, placeholders::_2)},
+      },
+      global_options(createGlobalOptions()) {}
+
+vector<string> Boo::paths_after_separator(int argc, char* argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        if (string(argv[i]) == "--") {
+            return vector<string>(argv + i + 1, argv + argc);
         }
-        visited.insert(curr_dir.string());
-        curr_dir = curr_dir.parent_path();
     }
-
-    return false;
-}
-
-void BooContext::set_head(string commit) {
-    ofstream head(get_head_file(), ios::trunc);
-    head << commit << endl;
+    return {};
 }
 
-string BooContext::get_head() {
-    namespace fs = filesystem;
-    if (fs::exists(get_head_file())) {
-        ifstream head_f(get_head_file());
-        string head;
-        head_f >> head;
-        return head;
-    } else {
-        // no head currently exists!
-        return "";
+Repository Boo::open_repository() {
+    try {
+        return Repository::open();
+    } catch (const boo_error& e) {
+        cout << "Unable to load repository in this or any parent directories. "
+                "Have you initialized a Boo repository?"
+             << endl;
+        throw command_exit_t{-1};
     }
 }
 
-string BooContext::get_head_file() {
-    return (repo_dir / BOO_DIR / HEAD_FILE_NAME).string();
-}
-
-bool BooContext::reset(string commit, bool force) {
-    namespace fs = filesystem;
-    if (!exists_commit(commit)) {
-        return false;
+void Boo::print_changes(const changes_t& changes) {
+    if (changes.new_files.size()) {
+        cout << "\033[1mNew Files:\033[0m"
+             << "\n";
+        cout << "\033[1;32m";
+        for (const auto& file : changes.new_files) {
+            cout << "+\t" << file << endl;
+        }
+        cout << "\033[0m";
     }
 
-    auto commit_dir = get_commit_folder(commit);
-    auto commit_hashes = parse_meta_file(commit);
-    auto current_hashes = calculate_current_hashes();
-    if (!force) {
-        auto head_hashes = parse_meta_file(get_head());
-        auto [h1, h2, h3] = calculate_diffs(head_hashes, current_hashes);
-        // if any file has been created, modified, or deleted, we abort
-        if (h1.size() || h2.size() || h3.size()) {
-            return false;
+    if (changes.modified_files.size()) {
+        cout << "\033[1mModified Files:\033[0m"
+             << "\n";
+        cout << "\033[1;33m";
+        for (const auto& file : changes.modified_files) {
+            cout << "+/-\t" << file << endl;
         }
+        cout << "\033[0m";
     }
 
-    auto [add, mod, del] = calculate_diffs(current_hashes, commit_hashes);
-
-    auto replace_file = [commit_dir, this](string file) {
-        string rel_path = file.substr(repo_dir.string().size() + 1);
-        fs::path to_del = file;
-        fs::path to_copy = commit_dir / rel_path;
-
-        debug_log("Replacing " + to_del.string() + " with " + to_copy.string());
-        if (fs::exists(to_del)) fs::remove(to_del);
-        if (fs::exists(to_copy)) fs::copy(to_copy, to_del);
-    };
-
-    for (auto const& file : add) replace_file(file);
-    for (auto const& file : mod) replace_file(file);
-    for (auto const& file : del) replace_file(file);
-    set_head(commit);
-
-    return true;
-}
-
-bool BooContext::exists_commit(string commit) {
-    namespace fs = filesystem;
-    fs::path commit_folder = get_commit_folder(commit);
-
-    return fs::exists(commit_folder) && fs::is_directory(commit_folder);
-}
-
-unordered_map<string, string> BooContext::calculate_current_hashes() {
-    namespace fs = std::filesystem;
-    auto boo_dir = repo_dir / BOO_DIR;
-    for (auto const& dir_entry : fs::recursive_directory_iterator(repo_dir)) {
-        if (dir_entry.path().string().starts_with(boo_dir.string())) {
-            continue;
+    if (changes.deleted_files.size()) {
+        cout << "\033[1mDeleted Files:\033[0m"
+             << "\n";
+        cout << "\033[1;31m";
+        for (const auto& file : changes.deleted_files) {
+            cout << "-\t" << file << endl;
         }
+        cout << "\033[0m";
+    }
 
-        if (dir_entry.is_regular_file()) {
-            ifstream file(dir_entry.path());
-            stringstream buffer;
-            sha_obj file_hash;
-            if (file) {
-                buffer << file.rdbuf();
-                commit_hash.update(buffer.str());
-                file_hash.update(buffer.str());
-
-                file_hashes[fs::absolute(dir_entry.path()).string()] =
-                    file_hash.get_hash_string();
-                debug_log("Hashed " + fs::absolute(dir_entry.path()).string() +
-                          " to " + file_hash.get_hash_string());
+    if (changes.renamed_files.size()) {
+        cout << "\033[1mRenamed Files:\033[0m"
+             << "\n";
+        cout << "\033[1;36m";
+        for (const auto& rename : changes.renamed_files) {
+            cout << "->\t" << rename.from << " -> " << rename.to;
+            if (rename.similarity < 100) {
+                cout << " (" << rename.similarity << "%)";
             }
+            cout << endl;
         }
+        cout << "\033[0m";
     }
-    debug_log("Commit hash: " + commit_hash.get_hash_string());
-    return file_hashes;
-}
 
-bool BooContext::create_context() {
-    debug_log("Creating a new Boo context in the pwd");
-    using namespace std::filesystem;
-    repo_dir = current_path();
-    path boo_path = repo_dir / BOO_DIR;
-    if (exists(boo_path)) {
-        // context already exists!
-        return false;
+    if (changes.copied_files.size()) {
+        cout << "\033[1mCopied Files:\033[0m"
+             << "\n";
+        cout << "\033[1;32m";
+        for (const auto& copy : changes.copied_files) {
+            cout << "+=\t" << copy.from << " -> " << copy.to << endl;
+        }
+        cout << "\033[0m";
     }
+}
+
+void Boo::print_checkout_report(const checkout_report_t& report) {
+    if (!report.files_written && !report.files_removed &&
+        !report.files_renamed) {
+        return;
+    }
+    double mb = report.bytes_written / (1024.0 * 1024.0);
+    cout << fixed << setprecision(1) << "Wrote " << report.files_written
+         << " files (" << mb << " MiB) and removed " << report.files_removed
+         << " in " << setprecision(3) << report.seconds << "s ("
+         << setprecision(1) << mb / max(report.seconds, 1e-9) << " MiB/s, "
+         << (report.files_written + report.files_removed) /
+                max(report.seconds, 1e-9)
+         << " files/s) on " << report.threads << " threads";
+    if (report.files_renamed) {
+        cout << ", renaming " << report.files_renamed << " files in place";
+    }
+    if (report.entries_swapped) {
+        cout << ", swapping in " << report.entries_swapped
+             << " top level entries";
+    }
+    cout << endl;
+    cout << defaultfloat;
+}
+
+void Boo::handle_init(int argc, char* argv[]) {
+    trace_span span("Boo::handle_init");
+    debug_log("Handling INIT function");
 
-    if (create_directory(boo_path)) {
-        // create commit log
-        ofstream infoFile(get_log_file());
-        return true;
+    try {
+        Repository::init();
+        cout << "Successfully initialized repository at the current directory"
+             << endl;
+    } catch (const boo_error& e) {
+        cout << "Failed to create empty repository at this location. Is there "
+                "already an open repository?"
+             << endl;
     }
-    return false;
 }
 
-tuple<unordered_set<string>, unordered_set<string>, unordered_set<string>>
-BooContext::calculate_diffs(unordered_map<string, string> from_hash,
-                            unordered_map<string, string> to_hash) {
-    unordered_set<string> new_files;
-    unordered_set<string> modified_files;
-    unordered_set<string> deleted_files;
+void Boo::handle_commit(int argc, char* argv[]) {
+    trace_span span("Boo::handle_commit");
+    debug_log("Handling COMMIT function");
+    Repository repo = open_repository();
+    auto options = createOptions();
 
-    for (const auto& curr : to_hash) {
-        string curr_path = curr.first;
-        string curr_hash = curr.second;
+    options.add_options()(
+        "m, message", "Commit message",
+        cxxopts::value<string>()->default_value("No message provided"))(
+        "h, help", "Provide help");
 
-        if (!from_hash.contains(curr_path)) {
-            // only exists currently, so this must be a new file
-            new_files.insert(curr_path);
-        } else {
-            if (curr_hash != from_hash[curr_path]) {
-                // the hashes don't match, but they exist both now and in the
-                // past, so this must be modified
-                debug_log("Detected modified hash for " + curr_path + " from " +
-                          from_hash[curr_path] + " to " + curr_hash);
-                modified_files.insert(curr_path);
-            }
-            // remove from head hashes
-            from_hash.erase(curr_path);
-        }
-    }
+    auto result = options.parse(argc, argv);
 
-    // all remaining elements in head hashes must be deleted files
-    for (const auto& curr : from_hash) {
-        deleted_files.insert(curr.first);
+    if (result.count("help")) {
+        cout << options.help() << endl;
+        throw command_exit_t{0};
     }
 
-    return make_tuple(new_files, modified_files, deleted_files);
+    repo.commit(result["message"].as<string>());
 }
 
-bool BooContext::commit(string message) {
-    namespace fs = std::filesystem;
-    if (repo_dir.empty()) {
-        debug_log("Unable to commit, was this context initialized?");
-        return false;
-    }
-    auto boo_dir = repo_dir / BOO_DIR;
-    // update for current time (if you wanna commit again)
-    commit_hash.update(
-        to_string(chrono::system_clock::now().time_since_epoch().count()));
+void Boo::handle_reset(int argc, char* argv[]) {
+    trace_span span("Boo::handle_reset");
+    debug_log("Handling RESET function");
+    auto options = createOptions();
 
-    fs::path commit_dir = boo_dir / commit_hash.get_hash_string();
-    if (!fs::create_directory(commit_dir)) {
-        debug_log("Couldn't create commit directory...");
-        return false;
+    options.add_options()(
+        "c, commit", "Commit hash (or an unambiguous prefix of it)",
+        cxxopts::value<string>())(
+        "h, help", "Provide help")(
+        "f, force", "Force reset (overwrite staged changes)",
+        cxxopts::value<bool>()->default_value("false"))(
+        "swap",
+        "Build changed top level entries aside and swap them in atomically",
+        cxxopts::value<bool>()->default_value("false"))(
+        "sparse", "Only restore files matching the patterns in this file",
+        cxxopts::value<string>());
+    options.custom_help("reset -c <commit> [options] [-- <path>...]");
+
+    auto result = options.parse(argc, argv);
+
+    if (result.count("help")) {
+        cout << options.help() << endl;
+        throw command_exit_t{0};
     }
 
-    log_commit(commit_hash.get_hash_string(), message);
-    ofstream meta(get_meta_file_of_commit(commit_hash.get_hash_string()));
-    set_head(commit_hash.get_hash_string());
+    if (!result.count("commit")) {
+        cout << "Reset requires a commit hash, passsed with the -c or --commit "
+                "argument"
+             << endl;
+        throw command_exit_t{-1};
+    }
 
-    // write metadata
-    for (auto const& dir_entry : fs::recursive_directory_iterator(repo_dir)) {
-        // ignore boo data
-        if (dir_entry.path().string().starts_with(boo_dir.string())) {
-            continue;
+    string commit = result["commit"].as<string>();
+    reset_options_t reset_options;
+    reset_options.force = result["force"].as<bool>();
+    reset_options.swap = result["swap"].as<bool>();
+    reset_options.paths = paths_after_separator(argc, argv);
+    if (result.count("sparse")) {
+        reset_options.sparse_file = result["sparse"].as<string>();
+    }
+    bool limited =
+        !reset_options.paths.empty() || !reset_options.sparse_file.empty();
+
+    Repository repo = open_repository();
+
+    try {
+        commit = repo.resolve(commit);
+        checkout_report_t report;
+        print_changes(repo.reset(commit, reset_options, &report));
+        if (limited) {
+            cout << "Successfully restored the selected files from commit " +
+                        commit + " (HEAD is unchanged)"
+                 << endl;
+        } else {
+            cout << "Successfully reset and set HEAD to commit " + commit
+                 << endl;
         }
-
-        if (dir_entry.is_regular_file()) {
-            meta << fs::absolute(dir_entry.path()).string() << endl;
-            meta << file_hashes[dir_entry.path().string()] << endl << endl;
+        print_checkout_report(report);
+    } catch (const boo_error& e) {
+        if (e.code() == boo_error::code_t::invalid_path ||
+            e.code() == boo_error::code_t::ambiguous_commit) {
+            cout << e.what() << endl;
+            throw command_exit_t{-1};
         }
+        cout << "Reset unsuccessful. You may be overwriting staged changes, "
+                "for which you would need the -f tag. Otherwise, are you sure "
+                "the commit exists?"
+             << endl;
     }
+}
 
-    // copy commit data
-    for (auto const& dir_entry : fs::directory_iterator(repo_dir)) {
-        // ignore boo data
-        if (dir_entry.path().string().starts_with(boo_dir.string())) {
-            continue;
-        }
+void Boo::handle_log(int argc, char* argv[]) {
+    trace_span span("Boo::handle_log");
+    auto options = createOptions();
+
+    options.add_options()("n, max-count", "Show at most this many commits",
+                          cxxopts::value<size_t>())(
+        "skip", "Skip this many commits before showing any",
+        cxxopts::value<size_t>()->default_value("0"))(
+        "stat",
+        "Show the number of files added, modified and deleted and the bytes "
+        "added and removed by each commit")("h, help", "Provide help");
+    options.custom_help("log [options] [-- <path>...]");
 
-        string rel_path_str = fs::absolute(dir_entry.path())
-                                  .string()
-                                  .substr(repo_dir.string().length() + 1);
-        fs::copy(dir_entry.path(), commit_dir / rel_path_str);
-        debug_log("Copying from " + dir_entry.path().string() + " to " +
-                  (commit_dir / rel_path_str).string());
+    auto result = options.parse(argc, argv);
+
+    if (result.count("help")) {
+        cout << options.help() << endl;
+        throw command_exit_t{0};
     }
 
-    return true;
-}
+    debug_log("Handling LOG function");
+    Repository repo = open_repository();
+    string head_commit = repo.head();
 
-void BooContext::log_commit(string hash, string message) {
-    ofstream log(get_log_file(), ios_base::app);
-    log << hash << endl;
-    log << message.length() << endl;
-    log << message << endl << endl;
-}
+    size_t remaining = result.count("max-count")
+                           ? result["max-count"].as<size_t>()
+                           : SIZE_MAX;
+    if (remaining == 0) return;
 
-filesystem::path BooContext::get_meta_file_of_commit(string commit) {
-    return repo_dir / BOO_DIR / (META_FILE_NAME + commit);
+    auto print_commit = [&head_commit](const commit_t& commit) {
+        string head_msg =
+            commit.hash == head_commit ? "\033[1;31m(HEAD)\033[0m" : "";
+        cout << "Commit: " << commit.hash << "\t" << head_msg << "\n"
+             << "Message: " << commit.message << "\n";
+    };
+    size_t skip = result["skip"].as<size_t>();
+    vector<string> paths = paths_after_separator(argc, argv);
+
+    // newest first straight off the log, flushed once at the end
+    if (result.count("stat")) {
+        repo.log_stats(
+            [&](const commit_t& commit, const commit_stats_t& stats) {
+                print_commit(commit);
+                cout << "Changes: "
+                     << stats.files_added + stats.files_modified +
+                            stats.files_deleted
+                     << " files (\033[32m" << stats.files_added
+                     << " added\033[0m, \033[33m" << stats.files_modified
+                     << " modified\033[0m, \033[31m" << stats.files_deleted
+                     << " deleted\033[0m), \033[32m+" << stats.bytes_added
+                     << "\033[0m \033[31m-" << stats.bytes_removed
+                     << "\033[0m bytes\n\n";
+                return --remaining > 0;
+            },
+            skip, paths);
+    } else {
+        repo.log(
+            [&](const commit_t& commit) {
+                print_commit(commit);
+                cout << "\n";
+                return --remaining > 0;
+            },
+            skip, paths);
+    }
+    cout.flush();
 }
 
-filesystem::path BooContext::get_commit_folder(string commit) {
-    return repo_dir / BOO_DIR / commit;
-}
+void Boo::handle_status(int argc, char* argv[]) {
+    trace_span span("Boo::handle_status");
+    auto options = createOptions();
 
-unordered_map<string, string> BooContext::parse_meta_file(string commit) {
-    debug_log("Parsing metafile for commit " + commit);
-    namespace fs = filesystem;
-    fs::path meta_path = get_meta_file_of_commit(commit);
-    unordered_map<string, string> parsed;
+    options.add_options()(
+        "q, quiet",
+        "Print nothing; exit with 1 if anything changed (stops at the first "
+        "change) and 0 otherwise")(
+        "M, find-renames",
+        "Also pair deleted and new files at least this similar (percent) as "
+        "renames",
+        cxxopts::value<int>()->default_value("0")->implicit_value("50"))(
+        "h, help", "Provide help");
+    options.custom_help("status [options] [-- <path>...]");
 
-    if (fs::exists(meta_path) && fs::is_regular_file(meta_path)) {
-        ifstream meta_file(meta_path);
+    auto result = options.parse(argc, argv);
 
-        while (!meta_file.eof() && !meta_file.bad()) {
-            string filepath, hash;
-            getline(meta_file, filepath);
-            getline(meta_file, hash);
-            meta_file.ignore(1);
+    if (result.count("help")) {
+        cout << options.help() << endl;
+        throw command_exit_t{0};
+    }
 
-            if (filepath.empty() || hash.empty()) continue;
+    Repository repo = open_repository();
+    debug_log("Handling STATUS function");
+    vector<string> paths = paths_after_separator(argc, argv);
 
-            debug_log("Parsed filepath: " + filepath + " with hash " + hash);
-            parsed[filepath] = hash;
-        }
+    if (result.count("quiet")) {
+        throw command_exit_t{repo.is_dirty(paths) ? 1 : 0};
     }
 
-    return parsed;
-}
+    status_t status = repo.status(paths, result["find-renames"].as<int>());
 
-string BooContext::get_log_file() { return repo_dir / BOO_DIR / LOG_FILE_NAME; }
+    cout << "These are the current distances from the HEAD commit ("
+         << status.head << ")" << endl;
+    print_changes(status.changes);
 
-vector<commit_t> BooContext::parse_log() {
-    debug_log("Parsing config file...");
-    vector<commit_t> commits;
-    ifstream log(get_log_file());
-
-    string commit_hash, message;
-    int message_length;
-    while (!log.eof()) {
-        log >> commit_hash >> message_length;
+    cout << "Run boo commit to commit these changes (they have been "
+            "automatically staged)"
+         << endl;
+}
 
-        // if the line was empty, just return
-        if (log.eof()) break;
+void Boo::handle_diff(int argc, char* argv[]) {
+    trace_span span("Boo::handle_diff");
+    debug_log("Handling DIFF function");
+    auto options = createOptions();
 
-        // ignore new line
-        log.ignore(1);
+    options.add_options()("command", "The command",
+                          cxxopts::value<string>())(
+        "commits", "The commits to compare",
+        cxxopts::value<vector<string>>())(
+        "p, patch", "Show line by line changes as a unified diff")(
+        "U, unified", "Lines of context around each change in the patch",
+        cxxopts::value<size_t>()->default_value("3"))(
+        "M, find-renames",
+        "Also pair deleted and new files at least this similar (percent) as "
+        "renames",
+        cxxopts::value<int>()->default_value("0")->implicit_value("50"))(
+        "h, help", "Provide help");
+    // so their values are not taken for commits
+    options.add_options("global")("trace", "", cxxopts::value<string>())(
+        "stats", "", cxxopts::value<string>())("stats-file", "",
+                                               cxxopts::value<string>());
+    options.parse_positional({"command", "commits"});
+    options.custom_help("diff [options] [<commit> [<commit>]]");
+    options.positional_help("");
 
-        char message_arr[message_length + 1];
-        log.read(message_arr, message_length);
+    auto result = options.parse(argc, argv);
 
-        message = string(message_arr, message_length);
+    if (result.count("help")) {
+        cout << options.help({""}) << endl;
+        throw command_exit_t{0};
+    }
 
-        debug_log("Found commit " + commit_hash + " with message <" + message +
-                  "> (" + to_string(message_length) + " bytes)");
-        commits.push_back(commit_t(commit_hash, message));
-        log.ignore(2);
+    vector<string> commits;
+    if (result.count("commits")) {
+        commits = result["commits"].as<vector<string>>();
+    }
+    if (commits.size() > 2) {
+        cout << "Diff takes at most two commit hashes (or unambiguous "
+                "prefixes)"
+             << endl;
+        throw command_exit_t{-1};
     }
 
-    return commits;
+    Repository repo = open_repository();
+    try {
+        // the working tree is compared to HEAD unless a commit is given
+        string from = commits.empty() ? repo.head() : repo.resolve(commits[0]);
+        if (from.empty()) {
+            cout << "Nothing has been committed to compare with" << endl;
+            throw command_exit_t{-1};
+        }
+        string to = commits.size() == 2 ? repo.resolve(commits[1]) : "";
+
+        if (result.count("patch")) {
+            repo.patch(cout, from, to, result["unified"].as<size_t>(),
+                       result["find-renames"].as<int>());
+            cout.flush();
+            return;
+        }
+        changes_t changes =
+            repo.diff(from, to, result["find-renames"].as<int>());
+        cout << "These are the changes from commit " << from << " to "
+             << (to.empty() ? "the working tree" : "commit " + to) << endl;
+        print_changes(changes);
+    } catch (const boo_error& e) {
+        cout << e.what() << endl;
+        throw command_exit_t{-1};
+    }
 }
 
-const unordered_set<string> Boo::commands{INIT, COMMIT, RESET, LOG, STATUS};
-unordered_map<string, string> Boo::command_descriptions{
-    {INIT, "Initializes a repository here"},
-    {COMMIT, "Commits to this repository, if it exists"},
-    {RESET, "Reset to a commit"},
-    {LOG, "See previous commits"},
-    {STATUS, "See current repository status"},
-};
+void Boo::handle_grep(int argc, char* argv[]) {
+    trace_span span("Boo::handle_grep");
+    debug_log("Handling GREP function");
+    auto options = createOptions();
 
-Boo::Boo()
-    : command_handlers{
-          {INIT,
-           bind(&Boo::handle_init, this, placeholders::_1, placeholders::_2)},
-          {COMMIT,
-           bind(&Boo::handle_commit, this, placeholders::_1, placeholders::_2)},
-          {RESET,
-           bind(&Boo::handle_reset, this, placeholders::_1, placeholders::_2)},
-          {LOG,
-           bind(&Boo::handle_log, this, placeholders::_1, placeholders::_2)},
-          {STATUS,
-           bind(&Boo::handle_status, this, placeholders::_1, placeholders::_2)},
-      }, ctx() {}
+    options.add_options()("command", "The command",
+                          cxxopts::value<string>())(
+        "pattern", "The string to search for", cxxopts::value<string>())(
+        "commits", "The commits to search", cxxopts::value<vector<string>>())(
+        "E, regex", "Treat the pattern as an ECMAScript regular expression")(
+        "a, all-commits", "Search every commit in the log")(
+        "l, files-with-matches", "Only print the files that match")(
+        "indexed",
+        "Only search the files the trigram index cannot rule out (creating "
+        "the index on first use)")(
+        "h, help", "Provide help");
+    // so their values are not taken for the pattern
+    options.add_options("global")("trace", "", cxxopts::value<string>())(
+        "stats", "", cxxopts::value<string>())("stats-file", "",
+                                               cxxopts::value<string>());
+    options.parse_positional({"command", "pattern", "commits"});
+    options.custom_help("grep [options] <pattern> [<commit>...]");
+    options.positional_help("");
 
-void Boo::handle_init(int argc, char* argv[]) {
-    debug_log("Handling INIT function");
+    auto result = options.parse(argc, argv);
 
-    if (!ctx.create_context()) {
-        cout << "Failed to create empty repository at this location. Is there "
-                "already an open repository?"
-             << endl;
-    } else {
-        cout << "Successfully initialized repository at the current directory"
-             << endl;
+    if (result.count("help") || !result.count("pattern")) {
+        cout << options.help({""}) << endl;
+        throw command_exit_t{result.count("help") ? 0 : -1};
+    }
+
+    grep_options_t grep_options;
+    grep_options.regex = result.count("regex");
+    grep_options.all_commits = result.count("all-commits");
+    grep_options.indexed = result.count("indexed");
+    if (result.count("commits")) {
+        grep_options.commits = result["commits"].as<vector<string>>();
+    }
+
+    Repository repo = open_repository();
+    vector<grep_match_t> matches;
+    try {
+        matches = repo.grep(result["pattern"].as<string>(), grep_options);
+    } catch (const boo_error& e) {
+        cout << e.what() << endl;
+        throw command_exit_t{-1};
+    }
+
+    // files are named commit:path once more than one commit is searched
+    bool show_commit =
+        grep_options.all_commits || grep_options.commits.size() > 1;
+    bool names_only = result.count("files-with-matches");
+    const grep_match_t* previous = nullptr;
+    for (const auto& match : matches) {
+        bool same_file = previous && previous->commit == match.commit &&
+                         previous->path == match.path;
+        previous = &match;
+        if (names_only && same_file) continue;
+
+        string name = "\033[35m" +
+                      (show_commit ? match.commit + ":" : string()) +
+                      match.path + "\033[0m";
+        if (names_only) {
+            cout << name << "\n";
+        } else if (match.line == 0) {
+            cout << "Binary file " << name << " matches\n";
+        } else {
+            cout << name << ":\033[32m" << match.line << "\033[0m:"
+                 << match.text << "\n";
+        }
     }
+    cout.flush();
+    // like grep, 1 if nothing matched
+    if (matches.empty()) throw command_exit_t{1};
 }
 
-void Boo::handle_commit(int argc, char* argv[]) {
-    debug_log("Handling COMMIT function");
-    if (!ctx.load_existing_context()) {
-        cout << "Unable to load repository in this or any parent directories. "
-                "Have you initialized a Boo repository?"
-             << endl;
-        exit(-1);
-    }
+void Boo::handle_show(int argc, char* argv[]) {
+    trace_span span("Boo::handle_show");
+    debug_log("Handling SHOW function");
     auto options = createOptions();
 
-    options.add_options()(
-        "m, message", "Commit message",
-        cxxopts::value<string>()->default_value("No message provided"))(
+    options.add_options()("command", "The command",
+                          cxxopts::value<string>())(
+        "object", "The commit and file", cxxopts::value<string>())(
         "h, help", "Provide help");
+    // so their values are not taken for the file
+    options.add_options("global")("trace", "", cxxopts::value<string>())(
+        "stats", "", cxxopts::value<string>())("stats-file", "",
+                                               cxxopts::value<string>());
+    options.parse_positional({"command", "object"});
+    options.custom_help("show <commit>:<path>");
+    options.positional_help("");
 
     auto result = options.parse(argc, argv);
 
     if (result.count("help")) {
-        cout << options.help() << endl;
-        exit(0);
+        cout << options.help({""}) << endl;
+        throw command_exit_t{0};
+    }
+
+    string object = result.count("object") ? result["object"].as<string>() : "";
+    size_t colon = object.find(':');
+    if (colon == string::npos || colon + 1 == object.size()) {
+        cout << "Show takes <commit>:<path>, e.g. HEAD:src/main.cpp" << endl;
+        throw command_exit_t{-1};
+    }
+    string commit = object.substr(0, colon);
+    string path = object.substr(colon + 1);
+
+    Repository repo = open_repository();
+    if (commit.empty() || commit == "HEAD") commit = repo.head();
+    // paths are from the root, like git, unless they start with ./ or ../
+    if (path.starts_with("./") || path.starts_with("../")) {
+        path = filesystem::absolute(path)
+                   .lexically_normal()
+                   .lexically_relative(repo.root())
+                   .string();
     }
 
-    ctx.calculate_current_hashes();
-    ctx.commit(result["message"].as<string>());
+    try {
+        if (output_capture::active()) {
+            // batch mode collects cout, which sendfile would bypass
+            repo.show(commit, path, cout);
+        } else {
+            // whatever is buffered goes first, as the file bypasses cout
+            cout.flush();
+            repo.show(commit, path, STDOUT_FILENO);
+        }
+    } catch (const boo_error& e) {
+        cout << e.what() << endl;
+        throw command_exit_t{-1};
+    }
 }
 
-void Boo::handle_reset(int argc, char* argv[]) {
-    debug_log("Handling RESET function");
+void Boo::handle_daemon(int argc, char* argv[]) {
+    trace_span span("Boo::handle_daemon");
+    debug_log("Handling DAEMON function");
     auto options = createOptions();
 
-    options.add_options()("c, commit", "Commit hash", cxxopts::value<string>())(
-        "h, help", "Provide help")(
-        "f, force", "Force reset (overwrite staged changes)",
-        cxxopts::value<bool>()->default_value("false"));
+    options.add_options()("d, detach", "Run in the background")(
+        "stop", "Stop the daemon serving this repository")(
+        "no-monitor", "Rescan the whole tree on every command")("h, help",
+                                                              "Provide help");
 
     auto result = options.parse(argc, argv);
 
     if (result.count("help")) {
         cout << options.help() << endl;
-        exit(0);
+        throw command_exit_t{0};
     }
 
-    if (!result.count("commit")) {
-        cout << "Reset requires a commit hash, passsed with the -c or --commit "
-                "argument"
-             << endl;
-        exit(-1);
-    }
+    // held for the daemon's lifetime, so every command it serves shares this
+    // repository's hash cache
+    Repository repo = open_repository();
+    filesystem::path root = repo.root();
+    filesystem::path boo_dir = repo.boo_dir();
 
-    string commit = result["commit"].as<string>();
-    bool force = result["force"].as<bool>();
-
-    if (!ctx.load_existing_context()) {
-        cout << "Unable to load repository in this or any parent directories. "
-                "Have you initialized a Boo repository?"
-             << endl;
-        exit(-1);
+    if (result.count("stop")) {
+        if (!BooDaemon::stop(boo_dir)) {
+            cout << "No daemon is running for this repository" << endl;
+            throw command_exit_t{-1};
+        }
+        cout << "Stopped the daemon for this repository" << endl;
+        return;
     }
 
-    auto current_hashes = ctx.calculate_current_hashes();
-
-    if (ctx.reset(commit, force)) {
-        auto reset_hashes = ctx.parse_meta_file(commit);
-        auto [new_files, modified_files, deleted_files] =
-            ctx.calculate_diffs(current_hashes, reset_hashes);
+    if (BooDaemon::is_running(boo_dir)) {
+        cout << "A daemon is already running for this repository" << endl;
+        throw command_exit_t{-1};
+    }
 
-        if (new_files.size()) {
-            cout << "\033[1mNew Files:\033[0m"
-                 << "\n";
-            cout << "\033[1;32m";
-            for (const auto& file : new_files) {
-                cout << "+\t" << file << endl;
-            }
-            cout << "\033[0m";
+    if (result.count("detach")) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            cout << "Unable to start the daemon" << endl;
+            throw command_exit_t{-1};
         }
-
-        if (modified_files.size()) {
-            cout << "\033[1mModified Files:\033[0m"
-                 << "\n";
-            cout << "\033[1;33m";
-            for (const auto& file : modified_files) {
-                cout << "+/-\t" << file << endl;
-            }
-            cout << "\033[0m";
+        if (pid > 0) {
+            cout << "Started daemon (pid " << pid << ") serving "
+                 << root.string() << endl;
+            return;
         }
+        setsid();
+        int devnull = open("/dev/null", O_RDWR);
+        dup2(devnull, STDIN_FILENO);
+        dup2(devnull, STDOUT_FILENO);
+        dup2(devnull, STDERR_FILENO);
+        close(devnull);
+    }
+
+    // with a monitor, scans only revisit the paths changed since the last one
+    fs_monitor monitor;
+    if (!result.count("no-monitor") && monitor.start(root, boo_dir)) {
+        repo.set_monitor(&monitor);
+    }
+
+    // warm the hash cache and the HEAD manifest before taking requests
+    repo.status();
+
+    BooDaemon daemon(boo_dir, [this](vector<string>& args) {
+        vector<char*> argv{(char*)"boo"};
+        for (auto& arg : args) argv.push_back(arg.data());
+        argv.push_back(nullptr);
+        return run(argv.size() - 1, argv.data());
+    });
+    if (monitor.get_fd() >= 0) {
+        // keep the kernel's event queue short so it does not overflow
+        daemon.watch(monitor.get_fd(), [&monitor] { monitor.drain(); });
+    }
+    if (!result.count("detach")) {
+        cout << "Serving " << root.string() << " on "
+             << BooDaemon::get_socket_file(boo_dir).string() << endl;
+    }
+    if (!daemon.serve()) {
+        cout << "Unable to listen on "
+             << BooDaemon::get_socket_file(boo_dir).string() << endl;
+        throw command_exit_t{-1};
+    }
+    repo.set_monitor(nullptr);
+}
 
-        if (deleted_files.size()) {
-            cout << "\033[1mDeleted Files:\033[0m"
-                 << "\n";
-            cout << "\033[1;31m";
-            for (const auto& file : deleted_files) {
-                cout << "-\t" << file << endl;
-            }
-            cout << "\033[0m";
-        }
+void Boo::handle_batch(int argc, char* argv[]) {
+    trace_span span("Boo::handle_batch");
+    debug_log("Handling BATCH function");
+    auto options = createOptions();
 
-        cout << "Successfully reset and set HEAD to commit " + commit << endl;
-    } else {
-        cout << "Reset unsuccessful. You may be overwriting staged changes, "
-                "for which you would need the -f tag. Otherwise, are you sure "
-                "the commit exists?"
-             << endl;
-    }
-}
+    options.add_options()("h, help", "Provide help");
 
-void Boo::handle_log(int argc, char* argv[]) {
-    debug_log("Handling LOG function");
-    if (!ctx.load_existing_context()) {
-        cout << "Unable to load repository in this or any parent directories. "
-                "Have you initialized a Boo repository?"
-             << endl;
-        exit(-1);
-    }
-    auto commits = ctx.parse_log();
-    string head_commit = ctx.get_head();
+    auto result = options.parse(argc, argv);
 
-    for (auto itr = commits.rbegin(); itr != commits.rend(); ++itr) {
-        commit_t commit = *itr;
-        string head_msg =
-            commit.hash == ctx.get_head() ? "\033[1;31m(HEAD)\033[0m" : "";
-        cout << "Commit: " << commit.hash << "\t" << head_msg << "\n"
-             << "Message: " << commit.message << "\n"
+    if (result.count("help")) {
+        cout << options.help() << endl;
+        cout << "Each line of stdin is a command line (e.g. status, or commit "
+                "-m \"message\"), or cd <directory> to change the directory "
+                "later commands run in. Each result is written as a header "
+                "line \"@@ <line> <exit code> <stdout bytes> <stderr bytes>\" "
+                "followed by the command's stdout and stderr."
              << endl;
+        throw command_exit_t{0};
     }
-}
 
-void Boo::handle_status(int argc, char* argv[]) {
-    if (!ctx.load_existing_context()) {
-        cout << "Unable to load repository in this or any parent directories. "
-                "Have you initialized a Boo repository?"
-             << endl;
-        exit(-1);
-    }
-    debug_log("Handling STATUS function");
+    // repositories stay open between commands, so their hash caches and
+    // parsed manifests are reused
+    map<filesystem::path, Repository> open_repositories;
 
-    string head = ctx.get_head();
-    auto current_hashes = ctx.calculate_current_hashes();
-    auto head_hashes = ctx.parse_meta_file(head);
+    string line;
+    for (u64 line_number = 1; getline(cin, line); ++line_number) {
+        vector<string> args;
+        int exit_code = -1;
+        string out, err;
 
-    auto [new_files, modified_files, deleted_files] =
-        ctx.calculate_diffs(head_hashes, current_hashes);
+        if (!string_utils::split_command_line(line, args)) {
+            err = "Unterminated quote\n";
+        } else if (args.empty() || args[0][0] == '#') {
+            continue;
+        } else if (args[0] == CHANGE_DIRECTORY) {
+            if (args.size() == 2 && chdir(args[1].c_str()) == 0) {
+                exit_code = 0;
+            } else {
+                err = "Unable to change directory\n";
+            }
+        } else if (args[0] == BATCH || args[0] == DAEMON) {
+            err = args[0] + " cannot be run from a batch\n";
+        } else {
+            try {
+                Repository repo = Repository::open();
+                open_repositories.emplace(repo.root(), repo);
+            } catch (const boo_error& e) {
+                // not in a repository (yet); the command reports it
+            }
 
-    cout << "These are the current distances from the HEAD commit (" << head
-         << ")" << endl;
-    if (new_files.size()) {
-        cout << "\033[1mNew Files:\033[0m"
-             << "\n";
-        cout << "\033[1;32m";
-        for (const auto& file : new_files) {
-            cout << "+\t" << file << endl;
+            output_capture capture;
+            vector<char*> command_argv{(char*)"boo"};
+            for (auto& arg : args) command_argv.push_back(arg.data());
+            command_argv.push_back(nullptr);
+            exit_code = run(command_argv.size() - 1, command_argv.data());
+            out = capture.out();
+            err = capture.err();
         }
-        cout << "\033[0m";
-    }
 
-    if (modified_files.size()) {
-        cout << "\033[1mModified Files:\033[0m"
-             << "\n";
-        cout << "\033[1;33m";
-        for (const auto& file : modified_files) {
-            cout << "+/-\t" << file << endl;
-        }
-        cout << "\033[0m";
+        cout << "@@ " << line_number << " " << exit_code << " " << out.size()
+             << " " << err.size() << "\n"
+             << out << err << flush;
     }
+}
 
-    if (deleted_files.size()) {
-        cout << "\033[1mDeleted Files:\033[0m"
-             << "\n";
-        cout << "\033[1;31m";
-        for (const auto& file : deleted_files) {
-            cout << "-\t" << file << endl;
-        }
-        cout << "\033[0m";
+bool Boo::forward_to_daemon(int argc, char* argv[], int& exit_code) {
+    if (getenv("BOO_NO_DAEMON")) return false;
+
+    string command;
+    try {
+        auto result = global_options.parse(argc, argv);
+        command = result["command"].as<string>();
+    } catch (const cxxopts::exceptions::exception& e) {
+        return false;
     }
+    if (!daemon_commands.count(command)) return false;
 
-    cout << "Run boo commit to commit these changes (they have been "
-            "automatically staged)"
-         << endl;
-}
+    BooContext ctx;
+    if (!ctx.load_existing_context()) return false;
 
-void debug_log(string s) {
-    if (verbose) {
-        cerr << "[DEBUG] " << s << endl;
-    }
+    auto socket_file = BooDaemon::get_socket_file(ctx.get_boo_dir());
+    if (!filesystem::exists(socket_file)) return false;
+
+    vector<string> args(argv + 1, argv + argc);
+    return BooDaemon::forward(ctx.get_boo_dir(), args, exit_code);
 }
 
 cxxopts::Options Boo::createOptions() {
@@ -551,30 +773,101 @@ cxxopts::Options Boo::createOptions() {
         .allow_unrecognised_options();
 }
 
-void Boo::handle_args(int argc, char* argv[]) {
+cxxopts::Options Boo::createGlobalOptions() {
     cxxopts::Options options = createOptions();
     options.add_options()("command", "The command to execute",
                           cxxopts::value<string>()->default_value(""))(
         "v, verbose", "Verbose mode",
-        cxxopts::value<bool>()->default_value("false"))("n, boon", "boon!")(
-        "h, help", "Print usage");
+        cxxopts::value<bool>()->default_value("false"))(
+        "trace", "Write a Chrome trace of the command to a file",
+        cxxopts::value<string>())(
+        "stats", "Print performance counters at exit (format: json)",
+        cxxopts::value<string>())(
+        "stats-file", "Append performance counters as a JSON line to a file",
+        cxxopts::value<string>())("n, boon", "boon!")("h, help",
+                                                      "Print usage");
 
     options.parse_positional({"command"});
+    return options;
+}
+
+int Boo::run(int argc, char* argv[]) {
+    try {
+        handle_args(argc, argv);
+    } catch (const command_exit_t& e) {
+        return e.code;
+    } catch (const cxxopts::exceptions::exception& e) {
+        cout << e.what() << endl;
+        return -1;
+    } catch (const filesystem::filesystem_error& e) {
+        cout << e.what() << endl;
+        return -1;
+    } catch (const boo_error& e) {
+        cout << e.what() << endl;
+        return -1;
+    }
+    return 0;
+}
+
+void Boo::handle_args(int argc, char* argv[]) {
+    cxxopts::Options& options = global_options;
     auto result = options.parse(argc, argv);
 
-    if (result["verbose"].as<bool>()) {
-        verbose = true;
-    }
+    verbose = result["verbose"].as<bool>();
 
-    if (result["boon"].as<bool>()) {
+    // only without a command, so commands may use -n themselves
+    if (result["boon"].as<bool>() && result["command"].as<string>().empty()) {
         debug_log("boon mode activated >:)");
         cout << "You right. Boon the goat!" << endl;
-        exit(0);
+        throw command_exit_t{0};
     }
 
     string command = result["command"].as<string>();
     debug_log("Received argument: " + command);
 
+    if (result.count("stats") && result["stats"].as<string>() != "json") {
+        cout << "Unsupported stats format " << result["stats"].as<string>()
+             << " (supported: json)" << endl;
+        throw command_exit_t{-1};
+    }
+
+    // writes the requested trace and stats once the command finishes, however
+    // it finishes
+    struct report_guard_t {
+        bool trace;
+        bool stats_stderr;
+        string stats_file;
+
+        ~report_guard_t() {
+            if (trace) {
+                if (!tracer::instance().write()) {
+                    cerr << "Unable to write trace file" << endl;
+                }
+                tracer::instance().disable();
+            }
+            if (stats_stderr || !stats_file.empty()) {
+                string json = stats::instance().to_json();
+                if (stats_stderr) cerr << json << endl;
+                if (!stats_file.empty()) {
+                    ofstream out(stats_file, ios_base::app);
+                    out << json << endl;
+                    if (!out) cerr << "Unable to write stats file" << endl;
+                }
+                stats::instance().disable();
+            }
+        }
+    } report{(bool)result.count("trace"), (bool)result.count("stats"),
+             result.count("stats-file") ? result["stats-file"].as<string>()
+                                        : ""};
+
+    if (report.trace) {
+        tracer::instance().enable(result["trace"].as<string>());
+    }
+    if (report.stats_stderr || !report.stats_file.empty()) {
+        stats::instance().enable();
+        stats::instance().set_command(command);
+    }
+
     if (command.empty() || !commands.count(command)) {
         if (result["help"].count()) {
             debug_log("Received help command");
@@ -582,7 +875,6 @@ void Boo::handle_args(int argc, char* argv[]) {
             cout << "Available arguments are: " << endl;
 
             print_available_commands();
-            exit(0);
         }
         // no argument was passed
         debug_log("No or unrecognized command was passed");
@@ -590,8 +882,6 @@ void Boo::handle_args(int argc, char* argv[]) {
                 "commands are: "
              << endl;
         print_available_commands();
-
-        exit(0);
     }
 
     // call the handlers for the command
@@ -603,7 +893,6 @@ void Boo::handle_args(int argc, char* argv[]) {
         cout << "Available arguments are: " << endl;
 
         print_available_commands();
-        exit(0);
     } else {
         cout << "Command not implemented. Available commands are: " << endl;
         print_available_commands();
@@ -615,9 +904,7 @@ void Boo::print_available_commands() {
         string cmd = *itr;
         cout << cmd << "\t" << command_descriptions[cmd] << endl;
     }
-    exit(0);
+    throw command_exit_t{0};
 }
 
 }  // namespace boo
-
-int main(int argc, char* argv[]) { Boo().handle_args(argc, argv); }
\ No newline at end of file
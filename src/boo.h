@@ -9,10 +9,9 @@
  *
  */
 #pragma once
+#include <fcntl.h>
 #include <unistd.h>
 
-#include <chrono>
-#include <filesystem>
 #include <functional>
 #include <iostream>
 #include <string>
@@ -21,264 +20,197 @@
 #include <vector>
 
 #include "include/cxxopts.hpp"
-#include "utils/sha.h"
-#include "utils/utils.h"
+#include "libboo.h"
 
 namespace boo {
-bool verbose = false;
 /**
- * @brief Debug logging
+ * @brief Thrown to end the current command early with an exit code. Lets a
+ * long running process (the daemon) run commands without exiting itself.
  *
- * @param the log statement
  */
-void debug_log(std::string s);
-
-/**
- * @brief representation of a boo commit
- *
- */
-struct commit_t {
-    std::string message;
-    std::string hash;
-
-    /**
-     * @brief Construct a new commit object
-     *
-     * @param message
-     * @param hash
-     */
-    commit_t(std::string message, std::string hash);
+struct command_exit_t {
+    int code;
 };
 
-class BooContext {
+class Boo {
    public:
-    BooContext();
-
-    /**
-     * @brief Loads an existing Boo context, if it exists in this directory
-     * or any ancestor directories
-     *
-     * @return true if able to load the context
-     * @return false otherwise
-     */
-    bool load_existing_context();
-
-    /**
-     * @brief Create a Boo context
-     *
-     * @return true if created a new context
-     * @return false otherwise
-     */
-    bool create_context();
-
-    /**
-     * @brief does a hash of each of the files, and a total hash for a commit
-     * if it were to exist
-     *
-     * @return std::unordered_map<std::string, std::string> a map of the current
-     * hashes
-     *
-     */
-    std::unordered_map<std::string, std::string> calculate_current_hashes();
-
-    /**
-     * @brief Creates a commit. Contingent on hashes being calculated beforehand
-     *
-     * @param message the commit message
-     * @return true if commit was successful
-     * @return false otherwise
-     */
-    bool commit(std::string message);
+    static const std::unordered_set<std::string> commands;
+    static const std::unordered_set<std::string>
+        daemon_commands;  // commands a running daemon serves
+    static std::unordered_map<std::string, std::string> command_descriptions;
+    std::unordered_map<std::string, std::function<void(int, char*[])>>
+        command_handlers;
 
     /**
-     * @brief Logs a commit to the end of the log
+     * @brief Construct a new Boo object
      *
-     * @param commit_hash
-     * @param message
      */
-    void log_commit(std::string commit_hash, std::string message);
+    Boo();
 
     /**
-     * @brief Get the meta filename of commit object
+     * @brief Create a default Options object with no options
      *
-     * @param commit the commit hash
-     * @return std::filesystem::path the path to the meta file
+     * @return cxxopts::Options default options
      */
-    std::filesystem::path get_meta_file_of_commit(std::string commit);
+    cxxopts::Options createOptions();
 
     /**
-     * @brief Gets the filepath to the log file
+     * @brief Create the options shared by all commands (the command itself,
+     * verbose, trace, stats...)
      *
-     * @return std::string the log filepath
+     * @return cxxopts::Options the global options
      */
-    std::string get_log_file();
+    cxxopts::Options createGlobalOptions();
 
     /**
-     * @brief Parses the log file into a list of commits arranged
-     * chronologically
+     * @brief Runs a whole command line
      *
-     * @return std::vector<commit> the commits
+     * @param argc the argument count
+     * @param argv the argument values
+     * @return int the exit code
      */
-    std::vector<commit_t> parse_log();
+    int run(int argc, char* argv[]);
 
     /**
-     * @brief Sets the head to the specified
+     * @brief Runs the command in this repository's daemon, if the command is
+     * one the daemon serves and a daemon is running
      *
-     * @param commit
+     * @param argc the argument count
+     * @param argv the argument values
+     * @param exit_code set to the command's exit code
+     * @return true if the daemon ran the command
+     * @return false if the command should be run in this process
      */
-    void set_head(std::string commit);
+    bool forward_to_daemon(int argc, char* argv[], int& exit_code);
 
     /**
-     * @brief Gets the commit hash of the head
+     * @brief Handle arguments
      *
-     * @return std::string the head commit
+     * @param argc the argument count
+     * @param argv the argument values
      */
-    std::string get_head();
+    void handle_args(int argc, char* argv[]);
 
     /**
-     * @brief Get the head file name
+     * @brief Handle the init function
      *
-     * @return std::string the file name
+     * @param argc
+     * @param argv
      */
-    std::string get_head_file();
+    void handle_init(int argc, char* argv[]);
 
     /**
-     * @brief Gets the path to the commit folder
+     * @brief Handle the commit function
      *
-     * @param commit the commit hash
-     * @return filesystem::path the path to the folder
+     * @param argc
+     * @param argv
      */
-    std::filesystem::path get_commit_folder(std::string commit);
+    void handle_commit(int argc, char* argv[]);
 
     /**
-     * @brief Parses a meta file for a commit, if it exists (if it doesn't,
-     * returns empty map).
+     * @brief Handle the reset function
      *
-     * @param commit the commit hash
-     * @return std::unordered_map<std::string, std::string> a map from
-     * filepath to hash
+     * @param argc
+     * @param argv
      */
-    std::unordered_map<std::string, std::string> parse_meta_file(
-        std::string commit);
+    void handle_reset(int argc, char* argv[]);
 
     /**
-     * @brief Returns whether a commit exists
+     * @brief Handle the log function
      *
-     * @param commit the commit hash
-     * @return true if the commit exists
-     * @return false otherwise
+     * @param argc
+     * @param argv
      */
-    bool exists_commit(std::string commit);
+    void handle_log(int argc, char* argv[]);
 
     /**
-     * @brief Calculates the difference between a from set of hashes (from
-     * path to hash) and a to set of hashes
+     * @brief Handle the status function
      *
-     * @param from_hash the original hashes
-     * @param to_hash the changed hashes
-     * @return std::tuple<std::unordered_set<std::string>,
-     * std::unordered_set<std::string>, std::unordered_set<std::string>> a
-     * tuple of created_files, modified_files, and deleted_files
+     * @param argc
+     * @param argv
      */
-    std::tuple<std::unordered_set<std::string>, std::unordered_set<std::string>,
-               std::unordered_set<std::string>>
-    calculate_diffs(std::unordered_map<std::string, std::string> from_hash,
-                    std::unordered_map<std::string, std::string> to_hash);
+    void handle_status(int argc, char* argv[]);
 
     /**
-     * @brief resets to a previous commit
+     * @brief Handle the diff function
      *
-     * @param commit the commit to reset to
-     * @param force to overwrite any staged changes
-     * @return true if the reset was successful
-     * @return false otherwise
+     * @param argc
+     * @param argv
      */
-    bool reset(std::string commit, bool force);
-
-   private:
-    std::filesystem::path repo_dir;
-    sha_obj commit_hash;  // the hash if we were to commit this
-    std::unordered_map<std::string, std::string>
-        file_hashes;  // the file hashes
-};
-
-class Boo {
-   public:
-    static const std::unordered_set<std::string> commands;
-    static std::unordered_map<std::string, std::string> command_descriptions;
-    std::unordered_map<std::string, std::function<void(int, char*[])>>
-        command_handlers;
+    void handle_diff(int argc, char* argv[]);
 
     /**
-     * @brief Construct a new Boo object
+     * @brief Handle the grep function
      *
+     * @param argc
+     * @param argv
      */
-    Boo();
+    void handle_grep(int argc, char* argv[]);
 
     /**
-     * @brief Create a default Options object with no options
+     * @brief Handle the show function
      *
-     * @return cxxopts::Options default options
+     * @param argc
+     * @param argv
      */
-    cxxopts::Options createOptions();
+    void handle_show(int argc, char* argv[]);
 
     /**
-     * @brief Handle arguments
+     * @brief Handle the daemon function
      *
-     * @param argc the argument count
-     * @param argv the argument values
+     * @param argc
+     * @param argv
      */
-    void handle_args(int argc, char* argv[]);
+    void handle_daemon(int argc, char* argv[]);
 
     /**
-     * @brief Handle the init function
+     * @brief Handle the batch function
      *
      * @param argc
      * @param argv
      */
-    void handle_init(int argc, char* argv[]);
+    void handle_batch(int argc, char* argv[]);
 
     /**
-     * @brief Handle the commit function
+     * @brief Prints the available arguments
      *
-     * @param argc
-     * @param argv
      */
-    void handle_commit(int argc, char* argv[]);
+    void print_available_commands();
+
+   private:
+    // built once and reused by every command this object runs
+    cxxopts::Options global_options;
 
     /**
-     * @brief Handle the reset function
+     * @brief Opens the repository in the current directory or an ancestor,
+     * ending the command if there is none
      *
-     * @param argc
-     * @param argv
+     * @return Repository the repository
      */
-    void handle_reset(int argc, char* argv[]);
+    Repository open_repository();
 
     /**
-     * @brief Handle the log function
+     * @brief Gets the arguments after "--" (usually paths)
      *
-     * @param argc
-     * @param argv
+     * @param argc the argument count
+     * @param argv the argument values
+     * @return std::vector<std::string> the arguments, empty if there is no
+     * "--"
      */
-    void handle_log(int argc, char* argv[]);
+    std::vector<std::string> paths_after_separator(int argc, char* argv[]);
 
     /**
-     * @brief Handle the status function
+     * @brief Prints new, modified and deleted files
      *
-     * @param argc
-     * @param argv
+     * @param changes the changes
      */
-    void handle_status(int argc, char* argv[]);
+    void print_changes(const changes_t& changes);
 
     /**
-     * @brief Prints the available arguments
+     * @brief Prints how much a reset wrote and how fast
      *
+     * @param report the checkout report
      */
-    void print_available_commands();
-
-   private:
-    BooContext ctx;
+    void print_checkout_report(const checkout_report_t& report);
 };
-}  // namespace boo
-
-int main(int argc, char* argv[]);
\ No newline at end of file
+}  // namespace boo
\ No newline at end of file
@@ -0,0 +1,164 @@
+/**
+ * @file changed_paths.cpp
+ * @author David Xu
+ * @brief Per-commit Bloom filters of the paths each commit changed
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "changed_paths.h"
+
+#include <cstring>
+#include <fstream>
+#include <unordered_set>
+
+#include "commit_log.h"
+#include "utils/fast_hash.h"
+#include "utils/stats.h"
+#include "utils/trace.h"
+
+#define FILTER_MAGIC "BOOPTH01"
+#define MAGIC_SIZE 8
+// 10 bits and 7 probes per path wrongly match about 1% of other paths
+#define BITS_PER_PATH 10
+#define PROBES 7
+// seeds the second of the two hashes the probes are derived from
+#define SECOND_SEED 0x9e3779b97f4a7c15ULL
+
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace boo {
+/**
+ * @brief the fixed header of a filter record, followed by bits / 8 bytes of
+ * filter
+ *
+ */
+struct filter_record_t {
+    u64 commit;
+    u64 parent;  // 0 if none
+    u32 bits;    // a multiple of 64
+    u32 probes;
+};
+
+/* the two hashes every probe of a path is derived from (double hashing) */
+static pair<u64, u64> probe_hashes(const string& path) {
+    return {fast_hash(path.data(), path.size()),
+            fast_hash(path.data(), path.size(), SECOND_SEED) | 1};
+}
+
+BooChangedPaths::BooChangedPaths(fs::path file) : file(file) {}
+
+bool BooChangedPaths::append(const string& commit, const string& parent,
+                             const vector<string>& paths) {
+    trace_span span("append_changed_paths");
+    filter_record_t record{0, 0, 0, PROBES};
+    if (!BooCommitLog::parse_hash(commit, record.commit) ||
+        (!parent.empty() && !BooCommitLog::parse_hash(parent, record.parent))) {
+        return false;
+    }
+
+    // a directory changed if anything under it did
+    unordered_set<string> keys;
+    for (const auto& path : paths) {
+        for (size_t end = path.size(); end != string::npos && end > 0;
+             end = path.rfind('/', end - 1)) {
+            if (!keys.insert(path.substr(0, end)).second) break;
+        }
+    }
+    u64 bits = max<u64>(64, (keys.size() * BITS_PER_PATH + 63) / 64 * 64);
+    if (bits > UINT32_MAX) return false;
+    record.bits = bits;
+
+    vector<u64> filter(bits / 64);
+    for (const auto& key : keys) {
+        auto [h1, h2] = probe_hashes(key);
+        for (u32 i = 0; i < record.probes; ++i) {
+            u64 bit = (h1 + i * h2) % bits;
+            filter[bit / 64] |= 1ULL << (bit % 64);
+        }
+    }
+
+    error_code ec;
+    bool empty = fs::file_size(file, ec) == 0 || ec;
+    {
+        ofstream out(file, ios::binary | ios::app);
+        if (empty) out.write(FILTER_MAGIC, MAGIC_SIZE);
+        out.write(reinterpret_cast<const char*>(&record), sizeof(record));
+        out.write(reinterpret_cast<const char*>(filter.data()), bits / 8);
+        if (!out) return false;
+    }
+    stats::count(counter_t::bytes_written, sizeof(record) + bits / 8);
+
+    // the mapping no longer covers the file
+    mapping.reset();
+    offsets.clear();
+    return true;
+}
+
+bool BooChangedPaths::find(const string& commit, string* parent) {
+    u64 value;
+    if (!BooCommitLog::parse_hash(commit, value)) return false;
+    load();
+    auto offset = offsets.find(value);
+    if (offset == offsets.end()) return false;
+    if (parent) {
+        filter_record_t record;
+        memcpy(&record, mapping->data() + offset->second, sizeof(record));
+        *parent = record.parent ? to_string(record.parent) : "";
+    }
+    return true;
+}
+
+bool BooChangedPaths::might_change(const string& commit,
+                                   const vector<string>& paths) {
+    u64 value;
+    if (!BooCommitLog::parse_hash(commit, value)) return true;
+    load();
+    auto offset = offsets.find(value);
+    if (offset == offsets.end()) return true;
+
+    filter_record_t record;
+    const char* data = mapping->data() + offset->second;
+    memcpy(&record, data, sizeof(record));
+    data += sizeof(record);
+    for (const auto& path : paths) {
+        auto [h1, h2] = probe_hashes(path);
+        bool all_set = true;
+        for (u32 i = 0; i < record.probes && all_set; ++i) {
+            u64 bit = (h1 + i * h2) % record.bits;
+            u64 word;
+            memcpy(&word, data + bit / 64 * sizeof(u64), sizeof(u64));
+            all_set = (word >> (bit % 64)) & 1;
+        }
+        if (all_set) return true;
+    }
+    stats::count(counter_t::cache_hits);
+    return false;
+}
+
+void BooChangedPaths::load() {
+    if (mapping) return;
+    trace_span span("load_changed_paths");
+    mapping = make_unique<mapped_file>(file);
+    if (mapping->size() < MAGIC_SIZE ||
+        memcmp(mapping->data(), FILTER_MAGIC, MAGIC_SIZE) != 0) {
+        return;
+    }
+
+    // only the headers are read; a record cut short by a crash ends the file
+    size_t offset = MAGIC_SIZE;
+    while (offset + sizeof(filter_record_t) <= mapping->size()) {
+        filter_record_t record;
+        memcpy(&record, mapping->data() + offset, sizeof(record));
+        if (record.bits == 0 || record.bits % 64 ||
+            record.bits / 8 > mapping->size() - offset - sizeof(record)) {
+            break;
+        }
+        offsets[record.commit] = offset;
+        offset += sizeof(record) + record.bits / 8;
+    }
+}
+}  // namespace boo
@@ -0,0 +1,89 @@
+/**
+ * @file changed_paths.h
+ * @author David Xu
+ * @brief Per-commit Bloom filters of the paths each commit changed
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "utils/mapped_file.h"
+#include "utils/utils.h"
+
+namespace boo {
+/**
+ * @brief The changed-path filters. The file is a magic number followed by one
+ * record per commit: a fixed header (commit, the parent it was compared to,
+ * filter size) and a Bloom filter holding every path the commit added,
+ * modified or deleted, plus each of their parent directories, so a query for
+ * a file or a directory is a few bit tests. A filter never misses a path the
+ * commit changed, and wrongly matches about 1% of the others, so history
+ * queries only open the manifests of the commits it matches.
+ *
+ * Records are appended at commit time; the file is mmapped and its records
+ * indexed by commit on first lookup.
+ *
+ */
+class BooChangedPaths {
+   public:
+    /**
+     * @brief Construct the filters
+     *
+     * @param file the filter file
+     */
+    explicit BooChangedPaths(std::filesystem::path file);
+
+    /**
+     * @brief Appends a commit's filter
+     *
+     * @param commit the commit hash
+     * @param parent the commit it was compared to, empty if none
+     * @param paths the changed files, relative to the repository root
+     * @return true if the filter was written
+     * @return false if a hash is malformed or the file cannot be written
+     */
+    bool append(const std::string& commit, const std::string& parent,
+                const std::vector<std::string>& paths);
+
+    /**
+     * @brief Looks up a commit's filter
+     *
+     * @param commit the commit hash
+     * @param parent if given, set to the commit it was compared to
+     * @return true if the commit has a filter
+     * @return false otherwise
+     */
+    bool find(const std::string& commit, std::string* parent = nullptr);
+
+    /**
+     * @brief Whether a commit may have changed a file or directory
+     *
+     * @param commit the commit hash
+     * @param paths files or directories relative to the repository root
+     * @return true if the filter matches any of them, or the commit has no
+     * filter
+     * @return false if the commit certainly changed none of them
+     */
+    bool might_change(const std::string& commit,
+                      const std::vector<std::string>& paths);
+
+   private:
+    /**
+     * @brief Maps the file and indexes its records, unless already done
+     *
+     */
+    void load();
+
+    std::filesystem::path file;
+    std::unique_ptr<mapped_file> mapping;
+    std::unordered_map<u64, size_t> offsets;  // commit to record offset
+};
+}  // namespace boo
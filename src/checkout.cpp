@@ -0,0 +1,401 @@
+/**
+ * @file checkout.cpp
+ * @author David Xu
+ * @brief Writes a commit's files into the working tree in parallel
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "checkout.h"
+
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <stdio.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+
+#include "utils/stats.h"
+#include "utils/thread_pool.h"
+#include "utils/trace.h"
+
+// operations handed to a worker at a time, so tiny files do not drown in
+// queueing overhead
+#define OPS_PER_TASK 64
+
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace boo {
+/**
+ * @brief Copies a file, sharing its blocks with the source (a reflink) where
+ * the file system supports it. The target must not exist.
+ *
+ * @param source the file to copy
+ * @param target the new file
+ * @param ec set on failure
+ * @return uintmax_t the number of bytes copied
+ */
+static uintmax_t clone_file(const fs::path& source, const fs::path& target,
+                            error_code& ec) {
+    int in = open(source.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (in < 0 || fstat(in, &st) != 0) {
+        ec = error_code(errno, system_category());
+        if (in >= 0) close(in);
+        return 0;
+    }
+    int out = open(target.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC,
+                   st.st_mode & 07777);
+    if (out < 0) {
+        ec = error_code(errno, system_category());
+        close(in);
+        return 0;
+    }
+
+    bool copied = ioctl(out, FICLONE, in) == 0;
+    // no reflinks here (or across these file systems); copy in the kernel
+    off_t remaining = copied ? 0 : st.st_size;
+    while (remaining > 0) {
+        ssize_t n = copy_file_range(in, nullptr, out, nullptr, remaining, 0);
+        if (n <= 0) break;
+        remaining -= n;
+    }
+    // and through user space if even that is unsupported
+    char buffer[64 * 1024];
+    while (remaining > 0) {
+        ssize_t n = read(in, buffer, sizeof(buffer));
+        if (n <= 0 || write(out, buffer, n) != n) break;
+        remaining -= n;
+    }
+
+    if (remaining > 0) ec = error_code(errno ? errno : EIO, system_category());
+    close(in);
+    if (close(out) != 0 && !ec) ec = error_code(errno, system_category());
+    return ec ? 0 : st.st_size;
+}
+
+BooCheckout::BooCheckout(fs::path repo_dir, fs::path commit_dir,
+                         unsigned threads)
+    : repo_dir(repo_dir),
+      commit_dir(commit_dir),
+      threads(threads ? threads : thread_pool::default_size()),
+      writes(),
+      removals() {}
+
+void BooCheckout::write(const string& file) { writes.push_back(file); }
+
+void BooCheckout::remove(const string& file) { removals.push_back(file); }
+
+void BooCheckout::rename(const string& from, const string& to) {
+    renames.push_back({from, to});
+}
+
+vector<size_t> BooCheckout::run_parallel(size_t count,
+                                         function<bool(size_t)> op) {
+    vector<size_t> failed;
+    mutex failed_lock;
+    auto run_range = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            if (op(i)) continue;
+            lock_guard<mutex> guard(failed_lock);
+            failed.push_back(i);
+        }
+    };
+
+    size_t tasks = (count + OPS_PER_TASK - 1) / OPS_PER_TASK;
+    if (tasks <= 1 || threads <= 1) {
+        run_range(0, count);
+    } else {
+        thread_pool pool(min<size_t>(threads, tasks));
+        for (size_t begin = 0; begin < count; begin += OPS_PER_TASK) {
+            pool.submit([&run_range, begin, count] {
+                run_range(begin, min<size_t>(begin + OPS_PER_TASK, count));
+            });
+        }
+        pool.wait();
+    }
+    sort(failed.begin(), failed.end());
+    return failed;
+}
+
+checkout_report_t BooCheckout::execute() {
+    trace_span span("checkout");
+    auto start = chrono::steady_clock::now();
+    checkout_report_t report;
+
+    // before removals, which could otherwise delete a file's new parent
+    // directory out from under it; whatever cannot be moved is rewritten
+    {
+        trace_span rename_span("rename_files");
+        for (const auto& [from, to] : renames) {
+            error_code ec;
+            fs::create_directories(to.parent_path(), ec);
+            if (!ec && !fs::exists(fs::symlink_status(to, ec))) {
+                fs::rename(from, to, ec);
+                if (!ec) {
+                    ++report.files_renamed;
+                    continue;
+                }
+            }
+            removals.push_back(from);
+            writes.push_back(to);
+        }
+        renames.clear();
+    }
+
+    size_t workers = (max(writes.size(), removals.size()) + OPS_PER_TASK - 1) /
+                     OPS_PER_TASK;
+    report.threads = max<size_t>(1, min<size_t>(threads, workers));
+
+    // removals first, so a file standing where a directory is needed is gone
+    // before directories are created
+    vector<size_t> failed_removals;
+    {
+        trace_span remove_span("remove_files");
+        failed_removals = run_parallel(removals.size(), [this](size_t i) {
+            error_code ec;
+            fs::remove(removals[i], ec);
+            return !ec;
+        });
+    }
+
+    // parents sort before their children, so each directory's parent exists
+    // by the time it is created
+    {
+        trace_span dir_span("create_directories");
+        set<fs::path> dirs;
+        for (const auto& file : writes) {
+            for (fs::path dir = file.parent_path();
+                 dir != repo_dir && dir.has_relative_path();
+                 dir = dir.parent_path()) {
+                if (!dirs.insert(dir).second) break;
+            }
+        }
+        set<fs::path> planned(removals.begin(), removals.end());
+        for (const auto& dir : dirs) {
+            error_code ec;
+            if (fs::is_directory(dir, ec)) continue;
+            if (fs::exists(fs::symlink_status(dir, ec))) {
+                // only a planned removal (one that failed above) is cleared;
+                // anything else in the way is not the checkout's to delete
+                if (!planned.contains(dir)) {
+                    throw fs::filesystem_error(
+                        "not part of the checkout, in the way of", dir,
+                        make_error_code(errc::file_exists));
+                }
+                fs::remove(dir);
+            }
+            fs::create_directory(dir);
+            ++report.directories_created;
+        }
+    }
+
+    atomic<u64> bytes_written = 0;
+    vector<size_t> failed_writes;
+    {
+        trace_span write_span("write_files");
+        size_t prefix = repo_dir.string().size() + 1;
+        auto write_file = [this, prefix, &bytes_written](size_t i) {
+            const fs::path& target = writes[i];
+            fs::path source = commit_dir / target.string().substr(prefix);
+            error_code ec;
+            fs::remove(target, ec);
+            if (ec) return false;
+            bytes_written += clone_file(source, target, ec);
+            return !ec;
+        };
+        failed_writes = run_parallel(writes.size(), write_file);
+    }
+
+    // retried serially in plan order, clearing whatever is in the way, and
+    // throwing if they still fail
+    {
+        trace_span fallback_span("checkout_fallbacks");
+        for (size_t i : failed_removals) {
+            fs::remove_all(removals[i]);
+        }
+        size_t prefix = repo_dir.string().size() + 1;
+        for (size_t i : failed_writes) {
+            const fs::path& target = writes[i];
+            fs::path source = commit_dir / target.string().substr(prefix);
+            fs::remove_all(target);
+            fs::create_directories(target.parent_path());
+            fs::copy_file(source, target);
+            bytes_written += fs::file_size(target);
+        }
+    }
+
+    report.files_written = writes.size();
+    report.files_removed = removals.size();
+    report.bytes_written = bytes_written;
+    report.fallbacks = failed_removals.size() + failed_writes.size();
+    report.seconds = chrono::duration<double>(chrono::steady_clock::now() -
+                                              start)
+                         .count();
+    stats::count(counter_t::bytes_written, report.bytes_written);
+    return report;
+}
+
+checkout_report_t BooCheckout::execute_swap(const fs::path& staging_dir) {
+    trace_span span("checkout_swap");
+    auto start = chrono::steady_clock::now();
+    checkout_report_t report;
+
+    // whole entries are rebuilt anyway
+    for (const auto& [from, to] : renames) {
+        removals.push_back(from);
+        writes.push_back(to);
+    }
+    renames.clear();
+
+    // the top level entries with any change beneath them
+    size_t prefix = repo_dir.string().size() + 1;
+    set<string> entries;
+    for (const auto* paths : {&writes, &removals}) {
+        for (const auto& file : *paths) {
+            string rel_path = file.string().substr(prefix);
+            entries.insert(rel_path.substr(0, rel_path.find('/')));
+        }
+    }
+
+    // may be left behind by an interrupted checkout
+    fs::remove_all(staging_dir);
+    fs::create_directories(staging_dir);
+
+    // build every affected entry as it is in the commit
+    vector<pair<fs::path, fs::path>> files;  // source to staged copy
+    {
+        trace_span stage_span("stage_entries");
+        for (const auto& entry : entries) {
+            fs::path source = commit_dir / entry;
+            if (!fs::is_directory(source)) {
+                if (fs::exists(source)) {
+                    files.push_back({source, staging_dir / entry});
+                }
+                continue;
+            }
+            fs::create_directory(staging_dir / entry);
+            ++report.directories_created;
+            for (const auto& item : fs::recursive_directory_iterator(source)) {
+                fs::path staged =
+                    staging_dir / entry / fs::relative(item.path(), source);
+                if (item.is_directory()) {
+                    fs::create_directory(staged);
+                    ++report.directories_created;
+                } else if (item.is_regular_file()) {
+                    files.push_back({item.path(), staged});
+                }
+            }
+        }
+    }
+
+    atomic<u64> bytes_written = 0;
+    vector<size_t> failed;
+    {
+        trace_span write_span("write_files");
+        failed = run_parallel(files.size(), [&files, &bytes_written](size_t i) {
+            error_code ec;
+            bytes_written += clone_file(files[i].first, files[i].second, ec);
+            return !ec;
+        });
+        for (size_t i : failed) {
+            fs::remove(files[i].second);
+            fs::copy_file(files[i].first, files[i].second);
+            bytes_written += fs::file_size(files[i].second);
+        }
+    }
+
+    // one rename per entry, so however the checkout is interrupted each entry
+    // is entirely old or entirely new
+    {
+        trace_span swap_span("swap_entries");
+        // the entries swapped so far and how, so a failure can undo them
+        enum class swap_t { exchanged, added, removed };
+        vector<pair<string, swap_t>> swapped;
+        auto undo = [&] {
+            for (auto it = swapped.rbegin(); it != swapped.rend(); ++it) {
+                fs::path live = repo_dir / it->first;
+                fs::path staged = staging_dir / it->first;
+                if (it->second == swap_t::exchanged) {
+                    renameat2(AT_FDCWD, staged.c_str(), AT_FDCWD, live.c_str(),
+                              RENAME_EXCHANGE);
+                } else if (it->second == swap_t::added) {
+                    ::rename(live.c_str(), staged.c_str());
+                } else {
+                    ::rename(staged.c_str(), live.c_str());
+                }
+            }
+        };
+
+        for (const auto& entry : entries) {
+            fs::path live = repo_dir / entry;
+            fs::path staged = staging_dir / entry;
+            bool has_live = fs::exists(fs::symlink_status(live));
+            bool has_staged = fs::exists(fs::symlink_status(staged));
+
+            int rc = 0;
+            swap_t kind = swap_t::exchanged;
+            if (has_live && has_staged) {
+                rc = renameat2(AT_FDCWD, staged.c_str(), AT_FDCWD, live.c_str(),
+                               RENAME_EXCHANGE);
+            } else if (has_staged) {
+                kind = swap_t::added;
+                rc = renameat2(AT_FDCWD, staged.c_str(), AT_FDCWD, live.c_str(),
+                               RENAME_NOREPLACE);
+            } else if (has_live) {
+                // deleted; moved aside and removed with the staging directory
+                kind = swap_t::removed;
+                rc = ::rename(live.c_str(), staged.c_str());
+            } else {
+                continue;
+            }
+
+            if (rc != 0) {
+                int error = errno;
+                // a half swapped tree is neither commit, so the entries
+                // already swapped are swapped back first
+                undo();
+                error_code ec;
+                fs::remove_all(staging_dir, ec);
+                if (error == EINVAL || error == ENOSYS || error == EXDEV) {
+                    // the file system cannot exchange this entry; the tree is
+                    // as it was, so the regular checkout can run instead
+                    return execute();
+                }
+                throw fs::filesystem_error(
+                    "unable to swap in", live,
+                    error_code(error, system_category()));
+            }
+            swapped.push_back({entry, kind});
+            ++report.entries_swapped;
+        }
+    }
+
+    {
+        // the old entries now sit in the staging directory
+        trace_span cleanup_span("remove_old_entries");
+        fs::remove_all(staging_dir);
+    }
+
+    size_t workers = (files.size() + OPS_PER_TASK - 1) / OPS_PER_TASK;
+    report.threads = max<size_t>(1, min<size_t>(threads, workers));
+    report.files_written = files.size();
+    report.files_removed = removals.size();
+    report.bytes_written = bytes_written;
+    report.fallbacks = failed.size();
+    report.seconds = chrono::duration<double>(chrono::steady_clock::now() -
+                                              start)
+                         .count();
+    stats::count(counter_t::bytes_written, report.bytes_written);
+    return report;
+}
+}  // namespace boo
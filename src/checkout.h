@@ -0,0 +1,112 @@
+/**
+ * @file checkout.h
+ * @author David Xu
+ * @brief Writes a commit's files into the working tree in parallel
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "libboo.h"
+
+namespace boo {
+/**
+ * @brief Applies a planned set of file writes and removals to the working
+ * tree. Removals run first, then the directories the writes need are created
+ * parents first, then the writes run across a thread pool. Anything that fails
+ * in parallel (e.g. a directory standing where a file goes) is retried
+ * serially in plan order afterwards.
+ *
+ */
+class BooCheckout {
+   public:
+    /**
+     * @brief Construct a new checkout
+     *
+     * @param repo_dir the working tree
+     * @param commit_dir the commit folder the files are copied from
+     * @param threads the number of threads (0 for one per hardware thread)
+     */
+    BooCheckout(std::filesystem::path repo_dir,
+                std::filesystem::path commit_dir, unsigned threads = 0);
+
+    /**
+     * @brief Plans replacing a file with its copy in the commit
+     *
+     * @param file the absolute path in the working tree
+     */
+    void write(const std::string& file);
+
+    /**
+     * @brief Plans moving a file within the working tree (it already has the
+     * content the commit has under its new name). Renames run serially
+     * before everything else; one that fails is turned into a removal and a
+     * write.
+     *
+     * @param from the absolute path of the file now
+     * @param to its absolute path in the commit
+     */
+    void rename(const std::string& from, const std::string& to);
+
+    /**
+     * @brief Plans removing a file
+     *
+     * @param file the absolute path in the working tree
+     */
+    void remove(const std::string& file);
+
+    /**
+     * @brief Applies the planned operations
+     *
+     * @return checkout_report_t what was done and how fast
+     * @throws std::filesystem::filesystem_error if an operation fails even
+     * when retried serially
+     */
+    checkout_report_t execute();
+
+    /**
+     * @brief Applies the planned operations (renames as removals and writes)
+     * by building each affected top level entry (file or directory) of the
+     * commit in a staging directory, with reflinks where possible, and
+     * exchanging it with the live entry in one renameat2(RENAME_EXCHANGE). An
+     * interrupted checkout leaves every top level entry either entirely old
+     * or entirely new, and if an entry cannot be swapped, those swapped
+     * before it are swapped back. Falls back to execute() if the file system
+     * cannot exchange entries.
+     *
+     * @param staging_dir a directory on the working tree's file system to
+     * build in (removed afterwards)
+     * @return checkout_report_t what was done and how fast
+     * @throws std::filesystem::filesystem_error if an entry cannot be built
+     * or swapped in
+     */
+    checkout_report_t execute_swap(const std::filesystem::path& staging_dir);
+
+   private:
+    /**
+     * @brief Runs op(i) for every i below count, in parallel when worthwhile
+     *
+     * @param count the number of operations
+     * @param op the operation, returning false if it failed
+     * @return std::vector<size_t> the failed operations, in plan order
+     */
+    std::vector<size_t> run_parallel(size_t count,
+                                     std::function<bool(size_t)> op);
+
+    std::filesystem::path repo_dir;
+    std::filesystem::path commit_dir;
+    unsigned threads;
+    std::vector<std::filesystem::path> writes;
+    std::vector<std::filesystem::path> removals;
+    std::vector<std::pair<std::filesystem::path, std::filesystem::path>>
+        renames;
+};
+}  // namespace boo
@@ -0,0 +1,433 @@
+/**
+ * @file commit_log.cpp
+ * @author David Xu
+ * @brief Binary commit log with a sorted hash index
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "commit_log.h"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+
+#include "utils/mapped_file.h"
+#include "utils/stats.h"
+#include "utils/trace.h"
+
+#define LOG_MAGIC "BOOLOG01"
+#define INDEX_MAGIC "BOOIDX01"
+#define MAGIC_SIZE 8
+// unindexed log bytes tolerated before the index is rebuilt (a few thousand
+// commits, scanned in well under a millisecond)
+#define INDEX_TAIL_LIMIT (64 * 1024)
+
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace boo {
+/**
+ * @brief the fixed header of a log record, followed by the message and the
+ * record's total length (u32)
+ *
+ */
+struct log_record_t {
+    u64 hash;
+    int64_t time;  // nanoseconds since the epoch, 0 if unknown
+    u32 message_length;
+    u32 reserved;
+};
+
+/**
+ * @brief the header of the index file, followed by count entries
+ *
+ */
+struct index_header_t {
+    char magic[MAGIC_SIZE];
+    u64 log_size;  // the log bytes the index covers
+    u64 count;
+};
+
+/**
+ * @brief one indexed commit
+ *
+ */
+struct index_entry_t {
+    u64 hash;
+    u64 offset;  // of the commit's record in the log
+};
+
+/* reads the record at offset, returning its length (0 if it is truncated,
+ * e.g. by a crash while appending) */
+static size_t read_record(const mapped_file& log, size_t offset,
+                          log_record_t& record, string_view& message) {
+    if (offset + sizeof(record) + sizeof(u32) > log.size()) return 0;
+    memcpy(&record, log.data() + offset, sizeof(record));
+    size_t length = sizeof(record) + record.message_length + sizeof(u32);
+    if (length > log.size() - offset) return 0;
+    u32 trailer;
+    memcpy(&trailer, log.data() + offset + length - sizeof(u32), sizeof(u32));
+    if (trailer != length) return 0;
+    message = string_view(log.data() + offset + sizeof(record),
+                          record.message_length);
+    return length;
+}
+
+/* validates a mapped index against the log it indexes */
+static bool load_index(const mapped_file& index, size_t log_size,
+                       const index_header_t*& header,
+                       const index_entry_t*& entries) {
+    if (index.size() < sizeof(index_header_t)) return false;
+    header = reinterpret_cast<const index_header_t*>(index.data());
+    entries = reinterpret_cast<const index_entry_t*>(index.data() +
+                                                     sizeof(index_header_t));
+    return memcmp(header->magic, INDEX_MAGIC, MAGIC_SIZE) == 0 &&
+           index.size() ==
+               sizeof(index_header_t) + header->count * sizeof(index_entry_t) &&
+           header->log_size >= MAGIC_SIZE && header->log_size <= log_size;
+}
+
+/* the length of the log up to the end of its last complete record; only
+ * the part the index does not cover is scanned */
+static size_t valid_size(const mapped_file& log, const fs::path& index_file) {
+    size_t offset = MAGIC_SIZE;
+    mapped_file index(index_file);
+    const index_header_t* header;
+    const index_entry_t* entries;
+    if (load_index(index, log.size(), header, entries)) {
+        offset = header->log_size;
+    }
+    log_record_t record;
+    string_view message;
+    while (size_t length = read_record(log, offset, record, message)) {
+        offset += length;
+    }
+    return offset;
+}
+
+/* whether the log starts with the binary format's magic number */
+static bool is_binary(const mapped_file& log) {
+    return log.size() >= MAGIC_SIZE &&
+           memcmp(log.data(), LOG_MAGIC, MAGIC_SIZE) == 0;
+}
+
+BooCommitLog::BooCommitLog(fs::path log_file, fs::path index_file)
+    : log_file(log_file), index_file(index_file) {}
+
+bool BooCommitLog::parse_hash(const string& hash, u64& value) {
+    if (hash.empty() || (hash.size() > 1 && hash[0] == '0')) return false;
+    auto [end, ec] = from_chars(hash.data(), hash.data() + hash.size(), value);
+    return ec == errc() && end == hash.data() + hash.size();
+}
+
+bool BooCommitLog::append(const string& hash, const string& message) {
+    trace_span span("append_log");
+    u64 value;
+    if (!parse_hash(hash, value) || message.size() > UINT32_MAX) return false;
+    // a record appended after a half written one would be unreachable
+    if (!upgrade() || !repair()) return false;
+
+    log_record_t record{
+        value, chrono::system_clock::now().time_since_epoch().count(),
+        (u32)message.size(), 0};
+    u32 length = sizeof(record) + message.size() + sizeof(u32);
+
+    error_code ec;
+    uintmax_t log_size = fs::file_size(log_file, ec);
+    if (ec) log_size = 0;
+    string bytes = log_size ? "" : LOG_MAGIC;
+    if (!log_size) log_size = MAGIC_SIZE;
+    bytes.append(reinterpret_cast<const char*>(&record), sizeof(record));
+    bytes += message;
+    bytes.append(reinterpret_cast<const char*>(&length), sizeof(length));
+    {
+        ofstream log(log_file, ios::binary | ios::app);
+        log.write(bytes.data(), bytes.size());
+        if (!log) return false;
+    }
+    stats::count(counter_t::bytes_written, bytes.size());
+    log_size += length;
+
+    // only the index header is read, so appending stays O(1) until the tail
+    // is long enough to be worth merging
+    index_header_t header;
+    uintmax_t indexed = MAGIC_SIZE;
+    ifstream index(index_file, ios::binary);
+    if (index.read(reinterpret_cast<char*>(&header), sizeof(header)) &&
+        memcmp(header.magic, INDEX_MAGIC, MAGIC_SIZE) == 0) {
+        indexed = header.log_size;
+    }
+    if (log_size - min(indexed, log_size) > INDEX_TAIL_LIMIT) update_index();
+    return true;
+}
+
+bool BooCommitLog::find(const string& hash, commit_t* commit) {
+    trace_span span("find_commit");
+    u64 value;
+    if (!parse_hash(hash, value) || !upgrade()) return false;
+
+    mapped_file log(log_file);
+    if (!is_binary(log)) return false;
+
+    auto found = [&](size_t offset) {
+        log_record_t record;
+        string_view message;
+        if (!read_record(log, offset, record, message)) return false;
+        if (record.hash != value) return false;
+        if (commit) *commit = commit_t(hash, string(message));
+        return true;
+    };
+
+    size_t offset = MAGIC_SIZE;
+    mapped_file index(index_file);
+    const index_header_t* header;
+    const index_entry_t* entries;
+    if (load_index(index, log.size(), header, entries)) {
+        const index_entry_t* end = entries + header->count;
+        const index_entry_t* entry = lower_bound(
+            entries, end, value,
+            [](const index_entry_t& e, u64 hash) { return e.hash < hash; });
+        if (entry != end && entry->hash == value) {
+            stats::count(counter_t::cache_hits);
+            return found(entry->offset);
+        }
+        offset = header->log_size;
+    }
+
+    // not indexed yet
+    stats::count(counter_t::cache_misses);
+    stats::count(counter_t::bytes_read, log.size() - offset);
+    log_record_t record;
+    string_view message;
+    while (size_t length = read_record(log, offset, record, message)) {
+        if (record.hash == value) return found(offset);
+        offset += length;
+    }
+    return false;
+}
+
+vector<string> BooCommitLog::resolve(const string& prefix, size_t limit) {
+    trace_span span("resolve_commit");
+    vector<string> matches;
+    u64 value;
+    // digits only, and hashes never start with 0
+    if (limit == 0 || !parse_hash(prefix, value)) return matches;
+    if (find(prefix)) {
+        matches.push_back(prefix);
+        return matches;
+    }
+
+    mapped_file log(log_file);
+    if (!is_binary(log)) return matches;
+
+    size_t offset = MAGIC_SIZE;
+    mapped_file index(index_file);
+    const index_header_t* header;
+    const index_entry_t* entries;
+    if (load_index(index, log.size(), header, entries)) {
+        const index_entry_t* end = entries + header->count;
+        auto below = [](const index_entry_t& e, u64 hash) {
+            return e.hash < hash;
+        };
+        // the hashes that are prefix followed by `digits` more digits
+        unsigned __int128 scale = 1;
+        for (size_t digits = 0; prefix.size() + digits <= 20; ++digits) {
+            unsigned __int128 low = value * scale;
+            unsigned __int128 high = ((unsigned __int128)value + 1) * scale;
+            scale *= 10;
+            if (digits > 0 && low > UINT64_MAX) break;
+            // the prefix itself was checked above
+            if (digits == 0) continue;
+            const index_entry_t* entry =
+                lower_bound(entries, end, (u64)low, below);
+            for (; entry != end && entry->hash < high; ++entry) {
+                matches.push_back(to_string(entry->hash));
+                if (matches.size() == limit) return matches;
+            }
+        }
+        offset = header->log_size;
+    }
+
+    // not indexed yet
+    log_record_t record;
+    string_view message;
+    while (size_t length = read_record(log, offset, record, message)) {
+        string hash = to_string(record.hash);
+        if (hash.starts_with(prefix)) {
+            matches.push_back(hash);
+            if (matches.size() == limit) break;
+        }
+        offset += length;
+    }
+    return matches;
+}
+
+vector<commit_t> BooCommitLog::read_all() {
+    trace_span span("read_log");
+    vector<commit_t> commits;
+    if (!upgrade()) return commits;
+    mapped_file log(log_file);
+    if (!is_binary(log)) return commits;
+    stats::count(counter_t::bytes_read, log.size());
+
+    size_t offset = MAGIC_SIZE;
+    log_record_t record;
+    string_view message;
+    while (size_t length = read_record(log, offset, record, message)) {
+        commits.emplace_back(to_string(record.hash), string(message));
+        offset += length;
+    }
+    return commits;
+}
+
+void BooCommitLog::walk_newest_first(function<bool(const commit_t&)> visit,
+                                     size_t skip) {
+    trace_span span("walk_log");
+    if (!upgrade()) return;
+    repair();
+    mapped_file log(log_file);
+    if (!is_binary(log)) return;
+
+    // each record ends with its length, so the one before it is found from
+    // its trailer; the walk starts at the last complete record even if the
+    // log could not be repaired
+    size_t end = valid_size(log, index_file);
+    u64 bytes_read = 0;
+    while (end >= MAGIC_SIZE + sizeof(log_record_t) + sizeof(u32)) {
+        u32 length;
+        memcpy(&length, log.data() + end - sizeof(u32), sizeof(u32));
+        if (length > end - MAGIC_SIZE) break;
+
+        log_record_t record;
+        string_view message;
+        if (read_record(log, end - length, record, message) != length) break;
+        end -= length;
+        if (skip) {
+            --skip;
+            bytes_read += sizeof(u32);
+            continue;
+        }
+        bytes_read += length;
+        if (!visit(commit_t(to_string(record.hash), string(message)))) break;
+    }
+    stats::count(counter_t::bytes_read, bytes_read);
+}
+
+bool BooCommitLog::repair() {
+    size_t valid;
+    {
+        mapped_file log(log_file);
+        if (!is_binary(log)) return true;
+        valid = valid_size(log, index_file);
+        if (valid == log.size()) return true;
+    }
+    trace_span span("repair_log");
+    error_code ec;
+    fs::resize_file(log_file, valid, ec);
+    return !ec;
+}
+
+bool BooCommitLog::upgrade() {
+    {
+        mapped_file log(log_file);
+        if (!log.is_open() || log.size() == 0 || is_binary(log)) return true;
+    }
+
+    trace_span span("upgrade_log");
+    ifstream text(log_file, ios::binary);
+    string bytes = LOG_MAGIC;
+    string hash, length;
+    while (getline(text, hash) && getline(text, length)) {
+        u64 value;
+        u64 message_length;
+        auto [end, ec] = from_chars(length.data(),
+                                    length.data() + length.size(),
+                                    message_length);
+        if (!parse_hash(hash, value) || ec != errc() ||
+            message_length > UINT32_MAX) {
+            return false;
+        }
+        string message(message_length, '\0');
+        if (!text.read(message.data(), message_length)) return false;
+        // the blank line after each message
+        text.ignore(2);
+
+        log_record_t record{value, 0, (u32)message_length, 0};
+        u32 record_length = sizeof(record) + message_length + sizeof(u32);
+        bytes.append(reinterpret_cast<const char*>(&record), sizeof(record));
+        bytes += message;
+        bytes.append(reinterpret_cast<const char*>(&record_length),
+                     sizeof(record_length));
+    }
+
+    fs::path tmp_file = log_file.string() + ".tmp";
+    {
+        ofstream log(tmp_file, ios::binary | ios::trunc);
+        log.write(bytes.data(), bytes.size());
+        if (!log) return false;
+    }
+    stats::count(counter_t::bytes_written, bytes.size());
+    error_code ec;
+    fs::remove(index_file, ec);
+    fs::rename(tmp_file, log_file);
+    update_index();
+    return true;
+}
+
+void BooCommitLog::update_index() {
+    trace_span span("update_index");
+    mapped_file log(log_file);
+    if (!is_binary(log)) return;
+
+    vector<index_entry_t> entries;
+    size_t offset = MAGIC_SIZE;
+    {
+        mapped_file index(index_file);
+        const index_header_t* header;
+        const index_entry_t* indexed;
+        if (load_index(index, log.size(), header, indexed)) {
+            entries.assign(indexed, indexed + header->count);
+            offset = header->log_size;
+        }
+    }
+
+    // the tail is sorted on its own and merged into the sorted entries
+    size_t indexed = entries.size();
+    log_record_t record;
+    string_view message;
+    while (size_t length = read_record(log, offset, record, message)) {
+        entries.push_back({record.hash, offset});
+        offset += length;
+    }
+    auto by_hash = [](const index_entry_t& a, const index_entry_t& b) {
+        return a.hash < b.hash;
+    };
+    sort(entries.begin() + indexed, entries.end(), by_hash);
+    inplace_merge(entries.begin(), entries.begin() + indexed, entries.end(),
+                  by_hash);
+
+    index_header_t header;
+    memcpy(header.magic, INDEX_MAGIC, MAGIC_SIZE);
+    header.log_size = offset;
+    header.count = entries.size();
+
+    // written aside and renamed, so readers never see a partial index
+    fs::path tmp_file = index_file.string() + ".tmp";
+    {
+        ofstream index(tmp_file, ios::binary | ios::trunc);
+        index.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        index.write(reinterpret_cast<const char*>(entries.data()),
+                    entries.size() * sizeof(index_entry_t));
+        if (!index) return;
+    }
+    stats::count(counter_t::objects_written);
+    stats::count(counter_t::bytes_written,
+                 sizeof(header) + entries.size() * sizeof(index_entry_t));
+    fs::rename(tmp_file, index_file);
+}
+}  // namespace boo
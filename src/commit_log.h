@@ -0,0 +1,135 @@
+/**
+ * @file commit_log.h
+ * @author David Xu
+ * @brief Binary commit log with a sorted hash index
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "libboo.h"
+#include "utils/utils.h"
+
+namespace boo {
+/**
+ * @brief The commit log. The log file is a magic number followed by one
+ * record per commit, oldest first: a fixed header (hash, time, message
+ * length), the message, and the record's total length (so the log can be
+ * read backwards). The index file holds (hash, offset) pairs sorted by hash
+ * for a prefix of the log; commits appended since are found by scanning the
+ * short unindexed tail, and the index is rebuilt once that tail grows past a
+ * limit, so appends stay O(1) and lookups are a binary search over the
+ * mmapped index. Logs in the old text format are converted on first use. A
+ * record left half written by a crash is truncated before the next append
+ * or newest first walk.
+ *
+ */
+class BooCommitLog {
+   public:
+    /**
+     * @brief Construct a new commit log
+     *
+     * @param log_file the log
+     * @param index_file its index
+     */
+    BooCommitLog(std::filesystem::path log_file,
+                 std::filesystem::path index_file);
+
+    /**
+     * @brief Appends a commit to the log
+     *
+     * @param hash the commit hash
+     * @param message the commit message
+     * @return true if the commit was logged
+     * @return false if the hash is malformed or the log cannot be written
+     */
+    bool append(const std::string& hash, const std::string& message);
+
+    /**
+     * @brief Looks up a commit
+     *
+     * @param hash the commit hash
+     * @param commit if given, set to the commit when found
+     * @return true if the commit is in the log
+     * @return false otherwise
+     */
+    bool find(const std::string& hash, commit_t* commit = nullptr);
+
+    /**
+     * @brief Finds the commits whose hash starts with a prefix. A prefix of k
+     * digits matches, for each hash length L, one contiguous range of the
+     * numerically sorted index ([prefix * 10^(L-k), (prefix + 1) * 10^(L-k))),
+     * so this is a binary search per length plus a scan of the unindexed
+     * tail. A full hash that exists matches only itself.
+     *
+     * @param prefix the leading digits of the hash
+     * @param limit stop after this many matches (2 suffices to detect
+     * ambiguity)
+     * @return std::vector<std::string> the matching hashes
+     */
+    std::vector<std::string> resolve(const std::string& prefix,
+                                     size_t limit = 2);
+
+    /**
+     * @brief Reads every commit, oldest first
+     *
+     */
+    std::vector<commit_t> read_all();
+
+    /**
+     * @brief Visits commits newest first by reading the log backwards from
+     * its end, so only the visited (and skipped) records are touched
+     *
+     * @param visit called per commit, returning false to stop
+     * @param skip the number of newest commits to pass over first
+     */
+    void walk_newest_first(std::function<bool(const commit_t&)> visit,
+                           size_t skip = 0);
+
+    /**
+     * @brief Parses a commit hash, rejecting anything that is not the decimal
+     * form commits are named with
+     *
+     * @param hash the hash
+     * @param value set to its value
+     * @return true if the hash is well formed
+     * @return false otherwise
+     */
+    static bool parse_hash(const std::string& hash, u64& value);
+
+   private:
+    /**
+     * @brief Converts a log in the old text format (hash, message length and
+     * message per commit) to the binary format, and indexes it
+     *
+     * @return true if the log is (now) binary or does not exist
+     * @return false if it could not be converted
+     */
+    bool upgrade();
+
+    /**
+     * @brief Truncates the log after its last complete record, found by
+     * scanning forward from the end of the indexed part
+     *
+     * @return true if the log is (now) whole or does not exist
+     * @return false if it could not be truncated
+     */
+    bool repair();
+
+    /**
+     * @brief Merges the commits appended since the index was written into it
+     *
+     */
+    void update_index();
+
+    std::filesystem::path log_file;
+    std::filesystem::path index_file;
+};
+}  // namespace boo
@@ -0,0 +1,114 @@
+/**
+ * @file commit_stats.cpp
+ * @author David Xu
+ * @brief Per-commit change summaries for log --stat
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "commit_stats.h"
+
+#include <cstring>
+#include <fstream>
+
+#include "commit_log.h"
+#include "utils/stats.h"
+#include "utils/trace.h"
+
+#define STATS_MAGIC "BOOSTA01"
+#define MAGIC_SIZE 8
+
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace boo {
+/**
+ * @brief one commit's summary as stored
+ *
+ */
+struct stats_record_t {
+    u64 commit;
+    u32 files_added;
+    u32 files_modified;
+    u32 files_deleted;
+    u32 reserved;
+    u64 bytes_added;
+    u64 bytes_removed;
+};
+
+BooCommitStats::BooCommitStats(fs::path file) : file(file), cursor(0) {}
+
+bool BooCommitStats::append(const string& commit,
+                            const commit_stats_t& stats) {
+    trace_span span("append_commit_stats");
+    stats_record_t record{0,
+                          stats.files_added,
+                          stats.files_modified,
+                          stats.files_deleted,
+                          0,
+                          stats.bytes_added,
+                          stats.bytes_removed};
+    if (!BooCommitLog::parse_hash(commit, record.commit)) return false;
+
+    error_code ec;
+    bool empty = fs::file_size(file, ec) == 0 || ec;
+    ofstream out(file, ios::binary | ios::app);
+    if (empty) out.write(STATS_MAGIC, MAGIC_SIZE);
+    out.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    if (!out) return false;
+    stats::count(counter_t::bytes_written, sizeof(record));
+    return true;
+}
+
+bool BooCommitStats::find(const string& commit, commit_stats_t& stats) {
+    u64 value;
+    if (!BooCommitLog::parse_hash(commit, value)) return false;
+    if (!mapping) {
+        mapping = make_unique<mapped_file>(file);
+        bool valid = mapping->size() >= MAGIC_SIZE &&
+                     memcmp(mapping->data(), STATS_MAGIC, MAGIC_SIZE) == 0;
+        // a record cut short by a crash is ignored
+        size_t records =
+            valid ? (mapping->size() - MAGIC_SIZE) / sizeof(stats_record_t)
+                  : 0;
+        cursor = MAGIC_SIZE + records * sizeof(stats_record_t);
+        if (!valid) cursor = 0;
+    }
+    if (cursor == 0) return false;
+
+    auto found = [&](size_t offset) {
+        stats_record_t record;
+        memcpy(&record, mapping->data() + offset, sizeof(record));
+        if (record.commit != value) return false;
+        stats = {record.files_added, record.files_modified,
+                 record.files_deleted, record.bytes_added,
+                 record.bytes_removed};
+        return true;
+    };
+
+    // the next older commit in the log is usually the record before
+    if (cursor > MAGIC_SIZE && found(cursor - sizeof(stats_record_t))) {
+        cursor -= sizeof(stats_record_t);
+        stats::count(counter_t::bytes_read, sizeof(stats_record_t));
+        return true;
+    }
+
+    if (offsets.empty()) {
+        trace_span span("index_commit_stats");
+        stats::count(counter_t::bytes_read, mapping->size());
+        size_t end = MAGIC_SIZE;
+        while (end + sizeof(stats_record_t) <= mapping->size()) {
+            u64 hash;
+            memcpy(&hash, mapping->data() + end, sizeof(hash));
+            offsets[hash] = end;
+            end += sizeof(stats_record_t);
+        }
+    }
+    auto offset = offsets.find(value);
+    if (offset == offsets.end()) return false;
+    cursor = offset->second;
+    return found(offset->second);
+}
+}  // namespace boo
@@ -0,0 +1,69 @@
+/**
+ * @file commit_stats.h
+ * @author David Xu
+ * @brief Per-commit change summaries for log --stat
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "libboo.h"
+#include "utils/mapped_file.h"
+#include "utils/utils.h"
+
+namespace boo {
+/**
+ * @brief The change summaries. The file is a magic number followed by one
+ * fixed size record per commit (hash, files added, modified and deleted,
+ * bytes added and removed), appended at commit time, so records are in log
+ * order. Lookups while walking the log newest first check the record before
+ * the previous match, which makes walking the whole log a sequential read of
+ * the mmapped file backwards; commits out of that order (e.g. summarized
+ * after the fact) are found through an index of every record, built on first
+ * use.
+ *
+ */
+class BooCommitStats {
+   public:
+    /**
+     * @brief Construct the summaries
+     *
+     * @param file the summary file
+     */
+    explicit BooCommitStats(std::filesystem::path file);
+
+    /**
+     * @brief Appends a commit's summary. Summaries appended after the first
+     * lookup are not visible to this object.
+     *
+     * @param commit the commit hash
+     * @param stats the summary
+     * @return true if the summary was written
+     * @return false if the hash is malformed or the file cannot be written
+     */
+    bool append(const std::string& commit, const commit_stats_t& stats);
+
+    /**
+     * @brief Looks up a commit's summary
+     *
+     * @param commit the commit hash
+     * @param stats set to the summary when found
+     * @return true if the commit has a summary
+     * @return false otherwise
+     */
+    bool find(const std::string& commit, commit_stats_t& stats);
+
+   private:
+    std::filesystem::path file;
+    std::unique_ptr<mapped_file> mapping;
+    size_t cursor;  // the record after the one to check first
+    std::unordered_map<u64, size_t> offsets;  // built on the first miss
+};
+}  // namespace boo
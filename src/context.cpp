@@ -0,0 +1,1200 @@
+/**
+ * @file context.cpp
+ * @author David Xu
+ * @brief Repository state and operations on the .boo directory
+ * @version 0.1
+ * @date 2023-04-20
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include "context.h"
+
+#include <algorithm>
+#include <fstream>
+#include <optional>
+#include <sstream>
+
+#include "checkout.h"
+#include "commit_log.h"
+#include "utils/chunk_fingerprint.h"
+#include "utils/fast_hash.h"
+#include "utils/line_diff.h"
+#include "utils/mapped_file.h"
+#include "utils/thread_pool.h"
+
+using namespace boo;
+using namespace std;
+
+#define BOO_DIR ".boo"
+#define LOG_FILE_NAME "log"
+#define LOG_INDEX_FILE_NAME "log.idx"
+#define CHANGED_PATHS_FILE_NAME "paths"
+#define COMMIT_STATS_FILE_NAME "stat"
+#define TRIGRAM_INDEX_DIR_NAME "trigrams"
+// deleted x new file pairs compared for similar renames at most
+#define RENAME_PAIR_LIMIT (1000 * 1000)
+// distinct files searched per task handed to a grep worker
+#define GREP_BLOBS_PER_TASK 16
+#define META_FILE_NAME "meta"
+#define HEAD_FILE_NAME "head"
+#define STAGING_DIR_NAME "staging"
+
+namespace boo {
+BooContext::BooContext()
+    : repo_dir(), monitor(nullptr), monitor_synced(false) {}
+
+bool BooContext::load_existing_context(filesystem::path start) {
+    trace_span span("load_existing_context");
+    debug_log("Attempting to load an existing Boo context");
+    using namespace std::filesystem;
+    if (!repo_dir.empty() && is_directory(repo_dir / BOO_DIR)) {
+        // already loaded (e.g. by a long running daemon)
+        return true;
+    }
+    auto curr_dir = absolute(start);
+
+    unordered_set<string> visited;
+
+    while (!visited.count(curr_dir.string())) {
+        debug_log("Searching for boo instances in " + curr_dir.string());
+        if (exists(curr_dir / BOO_DIR) && is_directory(curr_dir / BOO_DIR)) {
+            debug_log("Found a boo instance at " +
+                      (curr_dir / BOO_DIR).string());
+            repo_dir = curr_dir;
+
+            return true;
+        }
+        visited.insert(curr_dir.string());
+        curr_dir = curr_dir.parent_path();
+    }
+
+    return false;
+}
+
+void BooContext::set_head(string commit) {
+    ofstream head(get_head_file(), ios::trunc);
+    head << commit << endl;
+}
+
+string BooContext::get_head() {
+    namespace fs = filesystem;
+    if (fs::exists(get_head_file())) {
+        ifstream head_f(get_head_file());
+        string head;
+        head_f >> head;
+        return head;
+    } else {
+        // no head currently exists!
+        return "";
+    }
+}
+
+filesystem::path BooContext::get_boo_dir() { return repo_dir / BOO_DIR; }
+
+string BooContext::get_head_file() {
+    return (repo_dir / BOO_DIR / HEAD_FILE_NAME).string();
+}
+
+bool BooContext::reset(string commit, const reset_options_t& options,
+                       const path_filter* filter, changes_t* applied,
+                       checkout_report_t* report) {
+    trace_span span("reset");
+    if (!exists_commit(commit)) {
+        return false;
+    }
+
+    // a path limited reset only scans, compares and restores the selected
+    // files
+    bool limited = filter && !filter->empty();
+    unordered_map<string, string> limited_hashes;
+    if (limited) limited_hashes = calculate_hashes(*filter);
+    // one scan serves the safety check, the plan and the caller's summary
+    const auto& current_hashes =
+        limited ? limited_hashes : calculate_current_hashes();
+    auto select = [limited, filter](unordered_map<string, string> hashes) {
+        return limited ? filter->select(hashes) : hashes;
+    };
+
+    // if any file has been created, modified, or deleted, we abort
+    auto head_hashes = parse_meta_file(get_head());
+    if (!options.force && has_changes(select(head_hashes), current_hashes)) {
+        return false;
+    }
+
+    changes_t changes =
+        calculate_diffs(current_hashes, select(parse_meta_file(commit)));
+
+    // a limited reset may also need a path the filter left out: a file
+    // standing where a written file's directory goes. It is checked like the
+    // selected files, and planned for removal, as the checkout removes
+    // nothing outside its plan
+    vector<string> in_the_way;
+    if (limited) {
+        namespace fs = std::filesystem;
+        vector<string> targets = changes.new_files;
+        targets.insert(targets.end(), changes.modified_files.begin(),
+                       changes.modified_files.end());
+        for (const auto& rename : changes.renamed_files) {
+            targets.push_back(rename.to);
+        }
+        for (const auto& copy : changes.copied_files) {
+            targets.push_back(copy.to);
+        }
+
+        unordered_set<string> seen;
+        for (const auto& target : targets) {
+            for (fs::path dir = fs::path(target).parent_path();
+                 dir != repo_dir && dir.has_relative_path();
+                 dir = dir.parent_path()) {
+                if (!seen.insert(dir.string()).second) break;
+                error_code ec;
+                fs::directory_entry entry(dir, ec);
+                if (ec || !entry.exists() || entry.is_directory()) continue;
+                if (current_hashes.contains(dir.string())) continue;
+
+                auto head = head_hashes.find(dir.string());
+                string hash;
+                bool unchanged = head != head_hashes.end() &&
+                                 entry.is_regular_file() &&
+                                 hash_file(dir, entry.last_write_time(),
+                                           entry.file_size(), hash) &&
+                                 hash == head->second;
+                if (!unchanged && !options.force) return false;
+                in_the_way.push_back(dir.string());
+            }
+        }
+    }
+
+    BooCheckout checkout(repo_dir, get_commit_folder(commit));
+    for (auto const& file : in_the_way) checkout.remove(file);
+    for (auto const& file : changes.new_files) checkout.write(file);
+    for (auto const& file : changes.modified_files) checkout.write(file);
+    for (auto const& file : changes.deleted_files) checkout.remove(file);
+    // a file already in the tree under another name is moved, not rewritten
+    for (auto const& rename : changes.renamed_files) {
+        checkout.rename(rename.from, rename.to);
+    }
+    for (auto const& copy : changes.copied_files) checkout.write(copy.to);
+    checkout_report_t result;
+    // swapping replaces whole top level entries, so it needs the whole tree
+    if (options.swap && !limited) {
+        result = checkout.execute_swap(get_boo_dir() / STAGING_DIR_NAME);
+    } else {
+        result = checkout.execute();
+    }
+    if (report) *report = result;
+    if (applied) *applied = std::move(changes);
+    debug_log("Checked out " + to_string(result.files_written) + " files (" +
+              to_string(result.bytes_written) + " bytes) and removed " +
+              to_string(result.files_removed) + " on " +
+              to_string(result.threads) + " threads");
+    // the rest of the tree is still at HEAD after a path limited reset
+    if (!limited) set_head(commit);
+
+    return true;
+}
+
+bool BooContext::exists_commit(string commit) {
+    return open_log().find(commit);
+}
+
+vector<string> BooContext::resolve_commit(const string& prefix,
+                                          size_t limit) {
+    return open_log().resolve(prefix, limit);
+}
+
+void BooContext::walk_working_tree(
+    function<void(const filesystem::directory_entry&)> visit,
+    filesystem::path start) {
+    walk_working_tree_until(
+        [&visit](const filesystem::directory_entry& entry) {
+            visit(entry);
+            return true;
+        },
+        start);
+}
+
+bool BooContext::walk_working_tree_until(
+    function<bool(const filesystem::directory_entry&)> visit,
+    filesystem::path start) {
+    namespace fs = std::filesystem;
+    auto boo_dir = repo_dir / BOO_DIR;
+    if (start.empty()) start = repo_dir;
+    for (auto itr = fs::recursive_directory_iterator(start);
+         itr != fs::recursive_directory_iterator(); ++itr) {
+        // ignore boo data (without descending into it)
+        if (itr->path() == boo_dir) {
+            itr.disable_recursion_pending();
+            continue;
+        }
+        if (!visit(*itr)) return false;
+    }
+    return true;
+}
+
+bool BooContext::read_file(const filesystem::path& path, string& data,
+                           const string& trace_args) {
+    trace_span read_span("read", trace_args);
+    ifstream stream(path, ios::binary | ios::ate);
+    if (!stream) return false;
+    stats::count(counter_t::files_opened);
+    data.resize(stream.tellg());
+    stream.seekg(0);
+    stream.read(data.data(), data.size());
+    data.resize(stream.gcount());
+    stats::count(counter_t::bytes_read, data.size());
+    return true;
+}
+
+bool BooContext::digest_file(const filesystem::path& path, string& digest) {
+    string data;
+    if (!read_file(path, data)) return false;
+    trace_span span("digest");
+    sha_obj sha;
+    sha.update(data);
+    stats::count(counter_t::bytes_hashed, data.size());
+    digest = sha.get_hash_string();
+    return true;
+}
+
+bool BooContext::hash_file(const filesystem::path& path,
+                           filesystem::file_time_type mtime, uintmax_t size,
+                           string& hash) {
+    namespace fs = std::filesystem;
+    string abs_path = fs::absolute(path).string();
+
+    auto cached = hash_cache.find(abs_path);
+    if (cached != hash_cache.end() && cached->second.mtime == mtime &&
+        cached->second.size == size) {
+        stats::count(counter_t::cache_hits);
+        hash = cached->second.hash;
+        return true;
+    }
+
+    stats::count(counter_t::cache_misses);
+    string trace_args =
+        tracer::instance().enabled()
+            ? "\"path\":\"" + string_utils::json_escape(abs_path) + "\""
+            : "";
+    string data;
+    if (!read_file(path, data, trace_args)) return false;
+
+    // only detects changes; the digest is computed when a commit stores it
+    trace_span hash_span("hash", trace_args);
+    hash = fast_hash_string(data);
+    stats::count(counter_t::bytes_hashed, data.size());
+    debug_log("Hashed " + abs_path + " to " + hash);
+
+    // files modified this close to now could change again within the same
+    // mtime tick, so their hashes are not trusted on the next scan
+    if (mtime < fs::file_time_type::clock::now() - chrono::seconds(2)) {
+        hash_cache[abs_path] = {mtime, size, hash};
+    } else {
+        hash_cache.erase(abs_path);
+    }
+    return true;
+}
+
+void BooContext::set_monitor(fs_monitor* monitor) {
+    this->monitor = monitor;
+    monitor_synced = false;
+}
+
+bool BooContext::rescan_changed_paths() {
+    namespace fs = std::filesystem;
+    unordered_set<string> dirty;
+    if (!monitor || !monitor_synced || !monitor->take_changes(dirty)) {
+        return false;
+    }
+
+    trace_span span("rescan_changed_paths");
+    debug_log("Rescanning " + to_string(dirty.size()) + " changed paths");
+    auto rescan_file = [this](const fs::directory_entry& entry) {
+        stats::count(counter_t::files_stated);
+        string hash;
+        if (entry.is_regular_file() &&
+            hash_file(entry.path(), entry.last_write_time(),
+                      entry.file_size(), hash)) {
+            file_hashes[fs::absolute(entry.path()).string()] = hash;
+        }
+    };
+
+    for (const auto& path : dirty) {
+        if (file_hashes.erase(path)) hash_cache.erase(path);
+
+        error_code ec;
+        fs::directory_entry entry(path, ec);
+        if (ec || !entry.exists() || entry.is_directory()) {
+            // a directory appeared or disappeared: drop whatever we knew
+            // beneath it
+            string prefix = path + "/";
+            erase_if(file_hashes, [&prefix](const auto& item) {
+                return item.first.starts_with(prefix);
+            });
+        }
+
+        if (ec || !entry.exists()) continue;
+        if (entry.is_directory()) {
+            for (auto const& child : fs::recursive_directory_iterator(path)) {
+                rescan_file(child);
+            }
+        } else {
+            rescan_file(entry);
+        }
+    }
+    return true;
+}
+
+const unordered_map<string, string>& BooContext::calculate_current_hashes() {
+    namespace fs = std::filesystem;
+    trace_span scan_span("calculate_current_hashes");
+
+    // with a file system monitor only the paths it saw change are revisited
+    if (rescan_changed_paths()) return file_hashes;
+
+    // otherwise each scan starts from scratch; only the hash cache survives
+    file_hashes.clear();
+    if (monitor) {
+        // changes seen so far are covered by this scan; anything that changes
+        // while walking is picked up by the next one
+        unordered_set<string> covered;
+        monitor->take_changes(covered);
+    }
+
+    struct scanned_file_t {
+        fs::path path;
+        fs::file_time_type mtime;
+        uintmax_t size;
+    };
+    vector<scanned_file_t> files;
+    {
+        trace_span walk_span("walk");
+        walk_working_tree([&files](const fs::directory_entry& dir_entry) {
+            stats::count(counter_t::files_stated);
+            if (dir_entry.is_regular_file()) {
+                files.push_back({dir_entry.path(), dir_entry.last_write_time(),
+                                 dir_entry.file_size()});
+            }
+        });
+    }
+
+    for (auto const& file : files) {
+        string hash;
+        if (hash_file(file.path, file.mtime, file.size, hash)) {
+            file_hashes[fs::absolute(file.path).string()] = hash;
+        }
+    }
+
+    // forget cached hashes of files that no longer exist
+    erase_if(hash_cache, [this](const auto& item) {
+        return !file_hashes.contains(item.first);
+    });
+
+    monitor_synced = monitor != nullptr;
+    return file_hashes;
+}
+
+unordered_map<string, string> BooContext::calculate_hashes(
+    const path_filter& filter) {
+    namespace fs = std::filesystem;
+    if (filter.empty()) return calculate_current_hashes();
+    trace_span span("calculate_hashes");
+
+    // only the parts of the tree the filter can select are walked
+    unordered_map<string, string> hashes;
+    auto visit = [this, &filter, &hashes](const fs::directory_entry& entry) {
+        stats::count(counter_t::files_stated);
+        if (!entry.is_regular_file()) return;
+        string path = fs::absolute(entry.path()).string();
+        string hash;
+        if (filter.matches(path) &&
+            hash_file(entry.path(), entry.last_write_time(), entry.file_size(),
+                      hash)) {
+            hashes[path] = hash;
+        }
+    };
+    for (const auto& root : filter.roots()) {
+        error_code ec;
+        fs::directory_entry entry(root, ec);
+        if (ec || !entry.exists()) continue;
+        if (entry.is_directory()) {
+            walk_working_tree(visit, root);
+        } else {
+            visit(entry);
+        }
+    }
+    return hashes;
+}
+
+bool BooContext::is_dirty(const path_filter& filter) {
+    namespace fs = std::filesystem;
+    trace_span span("is_dirty");
+    auto head_hashes = filter.select(parse_meta_file(get_head()));
+
+    // a monitor makes a whole tree scan incremental, which beats a walk
+    if (filter.empty() && monitor && monitor_synced) {
+        return has_changes(head_hashes, calculate_current_hashes());
+    }
+
+    // otherwise walk, stopping at the first file that is new or changed;
+    // files are counted once even if overlapping roots reach them twice
+    unordered_set<string> unchanged;
+    auto visit = [this, &filter, &head_hashes,
+                  &unchanged](const fs::directory_entry& entry) {
+        stats::count(counter_t::files_stated);
+        if (!entry.is_regular_file()) return true;
+        string path = fs::absolute(entry.path()).string();
+        if (!filter.matches(path)) return true;
+
+        auto head = head_hashes.find(path);
+        string hash;
+        if (head == head_hashes.end() ||
+            !hash_file(entry.path(), entry.last_write_time(),
+                       entry.file_size(), hash) ||
+            hash != head->second) {
+            debug_log("First change found at " + path);
+            return false;
+        }
+        unchanged.insert(path);
+        return true;
+    };
+
+    for (const auto& root : filter.roots()) {
+        error_code ec;
+        fs::directory_entry entry(root, ec);
+        if (ec || !entry.exists()) continue;
+        bool clean = entry.is_directory() ? walk_working_tree_until(visit, root)
+                                          : visit(entry);
+        if (!clean) return true;
+    }
+    // every file found is unchanged, so any other HEAD file was deleted
+    return unchanged.size() != head_hashes.size();
+}
+
+bool BooContext::create_context(filesystem::path dir) {
+    debug_log("Creating a new Boo context in " + dir.string());
+    using namespace std::filesystem;
+    repo_dir = absolute(dir);
+    path boo_path = repo_dir / BOO_DIR;
+    if (exists(boo_path)) {
+        // context already exists!
+        return false;
+    }
+
+    if (create_directory(boo_path)) {
+        // create commit log
+        ofstream infoFile(get_log_file());
+        return true;
+    }
+    return false;
+}
+
+changes_t BooContext::calculate_diffs(
+    const unordered_map<string, string>& from_hash,
+    const unordered_map<string, string>& to_hash) {
+    trace_span span("calculate_diffs");
+    changes_t changes;
+
+    for (const auto& [curr_path, curr_hash] : to_hash) {
+        auto from = from_hash.find(curr_path);
+        if (from == from_hash.end()) {
+            // only exists currently, so this must be a new file
+            changes.new_files.push_back(curr_path);
+        } else if (curr_hash != from->second) {
+            // the hashes don't match, but they exist both now and in the
+            // past, so this must be modified
+            debug_log("Detected modified hash for " + curr_path + " from " +
+                      from->second + " to " + curr_hash);
+            changes.modified_files.push_back(curr_path);
+        }
+    }
+
+    // files only in the original hashes must have been deleted
+    for (const auto& [from_path, _] : from_hash) {
+        if (!to_hash.contains(from_path)) {
+            changes.deleted_files.push_back(from_path);
+        }
+    }
+
+    sort(changes.new_files.begin(), changes.new_files.end());
+    sort(changes.modified_files.begin(), changes.modified_files.end());
+    sort(changes.deleted_files.begin(), changes.deleted_files.end());
+    detect_renames(changes, from_hash, to_hash);
+    return changes;
+}
+
+void BooContext::detect_renames(changes_t& changes,
+                                const unordered_map<string, string>& from_hash,
+                                const unordered_map<string, string>& to_hash) {
+    if (changes.new_files.empty()) return;
+    trace_span span("detect_renames");
+    // empty files are all alike, so they say nothing about where a file
+    // came from
+    static const string empty_hash = fast_hash_string("");
+
+    // deleted files by content, each list in path order
+    unordered_map<string, vector<string>> deleted;
+    for (const auto& file : changes.deleted_files) {
+        const string& hash = from_hash.at(file);
+        if (hash != empty_hash) deleted[hash].push_back(file);
+    }
+    unordered_map<string, size_t> renamed_from;  // next unused per hash
+    unordered_set<string> renamed;
+    // the first (by path) of the earlier files with each content, built only
+    // if some new file is not a rename
+    unordered_map<string, string> sources;
+
+    vector<string> new_files;
+    for (const auto& file : changes.new_files) {
+        const string& hash = to_hash.at(file);
+        if (hash == empty_hash) {
+            new_files.push_back(file);
+            continue;
+        }
+        auto candidates = deleted.find(hash);
+        if (candidates != deleted.end() &&
+            renamed_from[hash] < candidates->second.size()) {
+            const string& from = candidates->second[renamed_from[hash]++];
+            changes.renamed_files.push_back({from, file});
+            renamed.insert(from);
+            continue;
+        }
+        if (sources.empty()) {
+            for (const auto& [path, from_file_hash] : from_hash) {
+                auto [source, added] =
+                    sources.try_emplace(from_file_hash, path);
+                if (!added && path < source->second) source->second = path;
+            }
+        }
+        auto source = sources.find(hash);
+        if (source != sources.end()) {
+            changes.copied_files.push_back({source->second, file});
+        } else {
+            new_files.push_back(file);
+        }
+    }
+    changes.new_files = std::move(new_files);
+    erase_if(changes.deleted_files,
+             [&renamed](const string& file) { return renamed.contains(file); });
+}
+
+void BooContext::detect_similar_renames(
+    changes_t& changes, int threshold,
+    function<filesystem::path(const string&)> from_file,
+    function<filesystem::path(const string&)> to_file) {
+    auto& deleted = changes.deleted_files;
+    auto& added = changes.new_files;
+    if (threshold <= 0 || deleted.empty() || added.empty()) return;
+    // every pair is compared, so give up on huge moves like git does
+    if (deleted.size() * added.size() > RENAME_PAIR_LIMIT) return;
+    trace_span span("detect_similar_renames");
+
+    auto fingerprint = [](const filesystem::path& path) {
+        mapped_file file(path);
+        return chunk_fingerprint(file.view());
+    };
+    vector<chunk_fingerprint> deleted_prints;
+    for (const auto& file : deleted) {
+        deleted_prints.push_back(fingerprint(from_file(file)));
+    }
+    vector<chunk_fingerprint> added_prints;
+    for (const auto& file : added) {
+        added_prints.push_back(fingerprint(to_file(file)));
+    }
+
+    // the most similar pairs are matched first
+    struct candidate_t {
+        int similarity;
+        size_t deleted, added;
+    };
+    vector<candidate_t> candidates;
+    for (size_t i = 0; i < deleted.size(); ++i) {
+        for (size_t j = 0; j < added.size(); ++j) {
+            const auto& a = deleted_prints[i];
+            const auto& b = added_prints[j];
+            // the smaller one can at best be entirely inside the larger
+            if (200 * min(a.size(), b.size()) <
+                (size_t)threshold * (a.size() + b.size())) {
+                continue;
+            }
+            int similarity = a.similarity(b);
+            if (similarity >= threshold) {
+                candidates.push_back({similarity, i, j});
+            }
+        }
+    }
+    stable_sort(candidates.begin(), candidates.end(),
+                [](const candidate_t& a, const candidate_t& b) {
+                    return a.similarity > b.similarity;
+                });
+
+    vector<bool> deleted_used(deleted.size());
+    vector<bool> added_used(added.size());
+    for (const auto& candidate : candidates) {
+        if (deleted_used[candidate.deleted] || added_used[candidate.added]) {
+            continue;
+        }
+        deleted_used[candidate.deleted] = added_used[candidate.added] = true;
+        changes.renamed_files.push_back({deleted[candidate.deleted],
+                                         added[candidate.added],
+                                         candidate.similarity});
+    }
+    sort(changes.renamed_files.begin(), changes.renamed_files.end(),
+         [](const rename_t& a, const rename_t& b) { return a.to < b.to; });
+
+    vector<string> remaining;
+    for (size_t i = 0; i < deleted.size(); ++i) {
+        if (!deleted_used[i]) remaining.push_back(deleted[i]);
+    }
+    deleted = std::move(remaining);
+    remaining.clear();
+    for (size_t j = 0; j < added.size(); ++j) {
+        if (!added_used[j]) remaining.push_back(added[j]);
+    }
+    added = std::move(remaining);
+}
+
+bool BooContext::has_changes(const unordered_map<string, string>& from_hash,
+                             const unordered_map<string, string>& to_hash) {
+    trace_span span("has_changes");
+    // equal sizes and every path present with the same hash means no file
+    // was created or deleted either
+    if (from_hash.size() != to_hash.size()) return true;
+    for (const auto& [path, hash] : to_hash) {
+        auto from = from_hash.find(path);
+        if (from == from_hash.end() || from->second != hash) return true;
+    }
+    return false;
+}
+
+bool BooContext::commit(string message) {
+    namespace fs = std::filesystem;
+    trace_span span("commit");
+    if (repo_dir.empty()) {
+        debug_log("Unable to commit, was this context initialized?");
+        return false;
+    }
+    auto boo_dir = repo_dir / BOO_DIR;
+
+    // only files whose content changed since the parent commit need a
+    // digest; the rest reuse the parent's
+    string parent = get_head();
+    auto parent_hashes = parse_meta_file(parent);
+    auto parent_digests = parse_meta_digests(parent);
+
+    vector<string> paths;
+    for (const auto& [path, _] : file_hashes) paths.push_back(path);
+    sort(paths.begin(), paths.end());
+
+    unordered_map<string, string> digests;
+    unordered_map<string, string> hashes;
+    {
+        trace_span digest_span("digest_files");
+        for (const auto& path : paths) {
+            const string& hash = file_hashes.at(path);
+            auto parent_hash = parent_hashes.find(path);
+            string digest;
+            if (parent_hash != parent_hashes.end() &&
+                parent_hash->second == hash) {
+                digest = parent_digests[path];
+            } else if (!digest_file(path, digest)) {
+                // removed since the scan
+                continue;
+            }
+            digests[path] = digest;
+            hashes[path] = hash;
+        }
+    }
+
+    // hash the digests in path order, so the commit hash does not depend on
+    // directory iteration order; paths are relative to the root, so the same
+    // tree hashes the same wherever it is checked out
+    size_t prefix = repo_dir.string().size() + 1;
+    sha_obj commit_hash;
+    for (const auto& path : paths) {
+        if (digests.contains(path)) {
+            commit_hash.update(path.substr(prefix) + "\n" +
+                               digests[path] + "\n");
+        }
+    }
+    // update for current time (if you wanna commit again)
+    commit_hash.update(
+        to_string(chrono::system_clock::now().time_since_epoch().count()));
+
+    fs::path commit_dir = boo_dir / commit_hash.get_hash_string();
+    if (!fs::create_directory(commit_dir)) {
+        debug_log("Couldn't create commit directory...");
+        return false;
+    }
+
+    // a commit missing from the log could never be found again, so HEAD
+    // only moves once it is logged
+    if (!log_commit(commit_hash.get_hash_string(), message)) {
+        error_code ec;
+        fs::remove_all(commit_dir, ec);
+        return false;
+    }
+    set_head(commit_hash.get_hash_string());
+
+    write_meta_file(commit_hash.get_hash_string(), digests, hashes);
+
+    // what history queries by path look for
+    vector<string> changed;
+    for (const auto& [path, hash] : hashes) {
+        auto parent_hash = parent_hashes.find(path);
+        if (parent_hash == parent_hashes.end() || parent_hash->second != hash) {
+            changed.push_back(path.substr(prefix));
+        }
+    }
+    for (const auto& [path, _] : parent_hashes) {
+        if (!hashes.contains(path)) changed.push_back(path.substr(prefix));
+    }
+    if (!open_changed_paths().append(commit_hash.get_hash_string(), parent,
+                                     changed)) {
+        debug_log("Unable to record the changed paths of the commit");
+    }
+
+    // copy commit data
+    trace_span copy_span("copy_commit_data");
+    for (const auto& path : paths) {
+        if (!digests.contains(path)) continue;
+        fs::path copy = commit_dir / path.substr(repo_dir.string().size() + 1);
+        fs::create_directories(copy.parent_path());
+        fs::copy_file(path, copy);
+        stats::count(counter_t::objects_written);
+        stats::count(counter_t::bytes_written, fs::file_size(copy));
+        debug_log("Copying from " + path + " to " + copy.string());
+    }
+
+    // only contents this commit introduced are new to the index
+    BooTrigramIndex index = open_trigram_index();
+    if (index.exists()) {
+        vector<pair<string, fs::path>> contents;
+        for (const auto& [path, hash] : hashes) {
+            auto parent_hash = parent_hashes.find(path);
+            if (parent_hash == parent_hashes.end() ||
+                parent_hash->second != hash) {
+                contents.push_back({hash, commit_dir / path.substr(prefix)});
+            }
+        }
+        if (!index.add(contents)) {
+            debug_log("Unable to update the trigram index");
+        }
+    }
+
+    // for log --stat, which then never compares manifests
+    commit_stats_t summary = summarize(commit_hash.get_hash_string(), parent,
+                                       hashes, parent_hashes);
+    if (!open_commit_stats().append(commit_hash.get_hash_string(), summary)) {
+        debug_log("Unable to record the summary of the commit");
+    }
+
+    return true;
+}
+
+vector<grep_match_t> BooContext::grep(const text_search& search,
+                                      const vector<string>& commits,
+                                      bool indexed) {
+    trace_span span("grep");
+    namespace fs = std::filesystem;
+    size_t prefix = repo_dir.string().size() + 1;
+
+    // each distinct content once, wherever it first appears
+    struct reference_t {
+        size_t commit;
+        string path;
+        size_t blob;
+    };
+    unordered_map<string, size_t> blob_ids;
+    vector<fs::path> blobs;
+    vector<string> blob_hashes;
+    vector<reference_t> references;
+    {
+        trace_span blob_span("collect_blobs");
+        for (size_t i = 0; i < commits.size(); ++i) {
+            for (const auto& [path, hash] : parse_meta_file(commits[i])) {
+                auto [id, added] = blob_ids.try_emplace(hash, blobs.size());
+                if (added) {
+                    blobs.push_back(get_commit_folder(commits[i]) /
+                                    path.substr(prefix));
+                    blob_hashes.push_back(hash);
+                }
+                references.push_back({i, path.substr(prefix), id->second});
+            }
+        }
+    }
+
+    // the contents the index cannot rule out; those it has not seen are
+    // indexed now, and searched directly this time
+    vector<bool> searched(blobs.size(), true);
+    if (indexed) {
+        BooTrigramIndex index = open_trigram_index();
+        index.create();
+        auto lookups = index.lookup(search.required(), blob_hashes);
+        vector<pair<string, fs::path>> unindexed;
+        for (size_t i = 0; i < blobs.size(); ++i) {
+            if (lookups[i] == BooTrigramIndex::lookup_t::absent) {
+                searched[i] = false;
+            } else if (lookups[i] == BooTrigramIndex::lookup_t::unindexed) {
+                unindexed.push_back({blob_hashes[i], blobs[i]});
+            }
+        }
+        if (!unindexed.empty() && !index.add(unindexed)) {
+            debug_log("Unable to update the trigram index");
+        }
+    }
+
+    struct line_match_t {
+        size_t line;
+        string text;
+    };
+    vector<vector<line_match_t>> hits(blobs.size());
+    {
+        trace_span search_span("search_blobs");
+        atomic<u64> bytes_read = 0;
+        auto search_blob = [&](size_t i) {
+            if (!searched[i]) return;
+            mapped_file file(blobs[i]);
+            bytes_read += file.size();
+            string_view text = file.view();
+            try {
+                if (line_diff::looks_binary(text)) {
+                    // reported once, like grep does
+                    auto first = [](size_t, string_view) { return false; };
+                    if (search.search(text, first)) hits[i].push_back({0, ""});
+                    return;
+                }
+                search.search(text, [&](size_t line, string_view match) {
+                    hits[i].push_back({line, string(match)});
+                    return true;
+                });
+            } catch (const regex_error&) {
+                // too complex for the regex engine; treated as no match
+                hits[i].clear();
+            }
+        };
+
+        size_t tasks = (blobs.size() + GREP_BLOBS_PER_TASK - 1) /
+                       GREP_BLOBS_PER_TASK;
+        unsigned threads = min<size_t>(thread_pool::default_size(), tasks);
+        if (threads <= 1) {
+            for (size_t i = 0; i < blobs.size(); ++i) search_blob(i);
+        } else {
+            thread_pool pool(threads);
+            for (size_t begin = 0; begin < blobs.size();
+                 begin += GREP_BLOBS_PER_TASK) {
+                pool.submit([&search_blob, begin, &blobs] {
+                    size_t end =
+                        min<size_t>(begin + GREP_BLOBS_PER_TASK, blobs.size());
+                    for (size_t i = begin; i < end; ++i) search_blob(i);
+                });
+            }
+            pool.wait();
+        }
+        stats::count(counter_t::files_opened,
+                     count(searched.begin(), searched.end(), true));
+        stats::count(counter_t::bytes_read, bytes_read);
+    }
+
+    sort(references.begin(), references.end(),
+         [](const reference_t& a, const reference_t& b) {
+             return tie(a.commit, a.path) < tie(b.commit, b.path);
+         });
+    vector<grep_match_t> matches;
+    for (const auto& reference : references) {
+        for (const auto& hit : hits[reference.blob]) {
+            matches.push_back({commits[reference.commit], reference.path,
+                               hit.line, hit.text});
+        }
+    }
+    return matches;
+}
+
+bool BooContext::log_commit(string hash, string message) {
+    trace_span span("log_commit");
+    if (!open_log().append(hash, message)) {
+        debug_log("Unable to log commit " + hash);
+        return false;
+    }
+    return true;
+}
+
+filesystem::path BooContext::get_meta_file_of_commit(string commit) {
+    return repo_dir / BOO_DIR / (META_FILE_NAME + commit);
+}
+
+filesystem::path BooContext::get_commit_folder(string commit) {
+    return repo_dir / BOO_DIR / commit;
+}
+
+bool BooContext::load_meta_file(const string& commit) {
+    trace_span span("parse_meta_file");
+    namespace fs = filesystem;
+
+    // meta files never change once written
+    if (!commit.empty() && commit == cached_meta_commit) {
+        stats::count(counter_t::cache_hits);
+        return true;
+    }
+
+    debug_log("Parsing metafile for commit " + commit);
+    fs::path meta_path = get_meta_file_of_commit(commit);
+    cached_meta_commit.clear();
+    cached_meta.clear();
+    cached_meta_digests.clear();
+    if (commit.empty() || !fs::is_regular_file(meta_path)) return false;
+
+    stats::count(counter_t::cache_misses);
+    ifstream meta_file(meta_path);
+    stats::count(counter_t::files_opened);
+    stats::count(counter_t::bytes_read, fs::file_size(meta_path));
+
+    bool upgraded = false;
+    while (!meta_file.eof() && !meta_file.bad()) {
+        string filepath, hashes;
+        getline(meta_file, filepath);
+        getline(meta_file, hashes);
+        meta_file.ignore(1);
+
+        if (filepath.empty() || hashes.empty()) continue;
+
+        // "<digest> <fast hash>"; older meta files only have the digest, so
+        // the fast hash is computed from the commit's copy of the file
+        size_t space = hashes.find(' ');
+        string digest = hashes.substr(0, space);
+        string fast;
+        if (space != string::npos) {
+            fast = hashes.substr(space + 1);
+        } else {
+            string data;
+            fs::path copy = get_commit_folder(commit) /
+                            filepath.substr(repo_dir.string().size() + 1);
+            if (!read_file(copy, data)) continue;
+            fast = fast_hash_string(data);
+            upgraded = true;
+        }
+
+        debug_log("Parsed filepath: " + filepath + " with hash " + fast);
+        cached_meta[filepath] = fast;
+        cached_meta_digests[filepath] = digest;
+    }
+    cached_meta_commit = commit;
+
+    // rewrite it in the current format so the copies are only read once
+    if (upgraded) write_meta_file(commit, cached_meta_digests, cached_meta);
+    return true;
+}
+
+void BooContext::write_meta_file(const string& commit,
+                                 const unordered_map<string, string>& digests,
+                                 const unordered_map<string, string>& hashes) {
+    namespace fs = filesystem;
+    trace_span span("write_meta_file");
+    vector<string> paths;
+    for (const auto& [path, _] : hashes) paths.push_back(path);
+    sort(paths.begin(), paths.end());
+
+    // written aside and renamed, so a reader never sees half a meta file
+    fs::path meta_path = get_meta_file_of_commit(commit);
+    fs::path tmp_path = meta_path.string() + ".tmp";
+    {
+        ofstream meta(tmp_path, ios::trunc);
+        for (const auto& path : paths) {
+            meta << path << "\n"
+                 << digests.at(path) << " " << hashes.at(path) << "\n\n";
+        }
+        stats::count(counter_t::objects_written);
+        stats::count(counter_t::bytes_written, meta.tellp());
+    }
+    fs::rename(tmp_path, meta_path);
+}
+
+unordered_map<string, string> BooContext::parse_meta_file(string commit) {
+    load_meta_file(commit);
+    return cached_meta;
+}
+
+bool BooContext::has_file(const string& commit, const string& file) {
+    // looked up in the cache rather than copied out of it
+    return load_meta_file(commit) && cached_meta.contains(file);
+}
+
+unordered_map<string, string> BooContext::parse_meta_digests(string commit) {
+    load_meta_file(commit);
+    return cached_meta_digests;
+}
+
+string BooContext::get_log_file() { return repo_dir / BOO_DIR / LOG_FILE_NAME; }
+
+vector<commit_t> BooContext::parse_log() {
+    trace_span span("parse_log");
+    debug_log("Parsing log file...");
+    return open_log().read_all();
+}
+
+void BooContext::walk_log(function<bool(const commit_t&)> visit, size_t skip) {
+    trace_span span("walk_log");
+    open_log().walk_newest_first(visit, skip);
+}
+
+void BooContext::walk_path_log(
+    const vector<string>& paths,
+    function<bool(const commit_t&, const string&)> visit, size_t skip) {
+    trace_span span("walk_path_log");
+    BooChangedPaths filters = open_changed_paths();
+    auto touches = [&paths](const vector<string>& changed) {
+        for (const auto& file : changed) {
+            for (const auto& path : paths) {
+                if (file.starts_with(path) && (file.size() == path.size() ||
+                                               file[path.size()] == '/')) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    };
+
+    // commits without a filter were made before filters were kept, and are
+    // compared to the next older commit
+    struct backfill_t {
+        string commit, parent;
+        vector<string> changed;
+    };
+    vector<backfill_t> backfills;
+    walk_log_pairs([&](const commit_t& commit, const string& older) {
+        string parent;
+        bool touched;
+        if (filters.find(commit.hash, &parent)) {
+            touched = filters.might_change(commit.hash, paths) &&
+                      touches(changed_paths(commit.hash, parent));
+        } else {
+            parent = older;
+            auto changed = changed_paths(commit.hash, parent);
+            touched = touches(changed);
+            backfills.push_back({commit.hash, parent, std::move(changed)});
+        }
+        if (!touched) return true;
+        if (skip) {
+            --skip;
+            return true;
+        }
+        return visit(commit, parent);
+    });
+
+    for (const auto& backfill : backfills) {
+        filters.append(backfill.commit, backfill.parent, backfill.changed);
+    }
+}
+
+void BooContext::walk_log_pairs(
+    function<bool(const commit_t&, const string&)> visit, size_t skip) {
+    // the older commit is only known a step later
+    optional<commit_t> newer;
+    bool stopped = false;
+    open_log().walk_newest_first(
+        [&](const commit_t& commit) {
+            if (newer && !visit(*newer, commit.hash)) {
+                stopped = true;
+                return false;
+            }
+            newer = commit;
+            return true;
+        },
+        skip);
+    if (newer && !stopped) visit(*newer, "");
+}
+
+commit_stats_t BooContext::commit_stats(BooCommitStats& summaries,
+                                        const string& commit,
+                                        const string& parent) {
+    commit_stats_t stats;
+    if (summaries.find(commit, stats)) return stats;
+
+    trace_span span("summarize_old_commit");
+    auto after = parse_meta_file(commit);
+    stats = summarize(commit, parent, after, parse_meta_file(parent));
+    summaries.append(commit, stats);
+    return stats;
+}
+
+BooCommitLog BooContext::open_log() {
+    return BooCommitLog(get_log_file(),
+                        repo_dir / BOO_DIR / LOG_INDEX_FILE_NAME);
+}
+
+BooChangedPaths BooContext::open_changed_paths() {
+    return BooChangedPaths(repo_dir / BOO_DIR / CHANGED_PATHS_FILE_NAME);
+}
+
+BooTrigramIndex BooContext::open_trigram_index() {
+    return BooTrigramIndex(repo_dir / BOO_DIR / TRIGRAM_INDEX_DIR_NAME);
+}
+
+BooCommitStats BooContext::open_commit_stats() {
+    return BooCommitStats(repo_dir / BOO_DIR / COMMIT_STATS_FILE_NAME);
+}
+
+commit_stats_t BooContext::summarize(
+    const string& commit, const string& parent,
+    const unordered_map<string, string>& after,
+    const unordered_map<string, string>& before) {
+    trace_span span("summarize");
+    namespace fs = std::filesystem;
+    size_t prefix = repo_dir.string().size() + 1;
+    auto size_in = [&](const string& of, const string& path) -> uintmax_t {
+        error_code ec;
+        uintmax_t size =
+            fs::file_size(get_commit_folder(of) / path.substr(prefix), ec);
+        stats::count(counter_t::files_stated);
+        return ec ? 0 : size;
+    };
+
+    commit_stats_t stats;
+    for (const auto& [path, hash] : after) {
+        auto old = before.find(path);
+        if (old == before.end()) {
+            ++stats.files_added;
+            stats.bytes_added += size_in(commit, path);
+        } else if (old->second != hash) {
+            ++stats.files_modified;
+            uintmax_t new_size = size_in(commit, path);
+            uintmax_t old_size = size_in(parent, path);
+            if (new_size > old_size) stats.bytes_added += new_size - old_size;
+            if (old_size > new_size) stats.bytes_removed += old_size - new_size;
+        }
+    }
+    for (const auto& [path, _] : before) {
+        if (after.contains(path)) continue;
+        ++stats.files_deleted;
+        stats.bytes_removed += size_in(parent, path);
+    }
+    return stats;
+}
+
+vector<string> BooContext::changed_paths(const string& commit,
+                                         const string& parent) {
+    trace_span span("changed_paths");
+    // the parent last, as it is the next commit a walk compares
+    auto after = parse_meta_file(commit);
+    auto before = parse_meta_file(parent);
+    size_t prefix = repo_dir.string().size() + 1;
+    vector<string> changed;
+    for (const auto& [path, hash] : after) {
+        auto old = before.find(path);
+        if (old == before.end() || old->second != hash) {
+            changed.push_back(path.substr(prefix));
+        }
+    }
+    for (const auto& [path, _] : before) {
+        if (!after.contains(path)) changed.push_back(path.substr(prefix));
+    }
+    return changed;
+}
+
+void debug_log(string s) {
+    if (verbose) {
+        cerr << "[DEBUG] " << s << endl;
+    }
+}
+}  // namespace boo
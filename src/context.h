@@ -0,0 +1,560 @@
+/**
+ * @file context.h
+ * @author David Xu
+ * @brief Repository state and operations on the .boo directory
+ * @version 0.1
+ * @date 2023-04-20
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "changed_paths.h"
+#include "commit_log.h"
+#include "commit_stats.h"
+#include "trigram_index.h"
+#include "libboo.h"
+#include "utils/fs_monitor.h"
+#include "utils/path_filter.h"
+#include "utils/sha.h"
+#include "utils/text_search.h"
+#include "utils/trace.h"
+#include "utils/utils.h"
+
+namespace boo {
+// process wide switch for debug_log
+inline std::atomic<bool> verbose = false;
+/**
+ * @brief Debug logging
+ *
+ * @param the log statement
+ */
+void debug_log(std::string s);
+
+/**
+ * @brief a file hash, valid while the file's mtime and size are unchanged
+ *
+ */
+struct cached_hash_t {
+    std::filesystem::file_time_type mtime;
+    uintmax_t size;
+    std::string hash;
+};
+
+/**
+ * @brief The state of one repository. Not thread safe: Repository (libboo.h)
+ * serializes access to it.
+ *
+ */
+class BooContext {
+   public:
+    BooContext();
+
+    /**
+     * @brief Loads an existing Boo context, if it exists in this directory
+     * or any ancestor directories
+     *
+     * @param start the directory to start searching from
+     * @return true if able to load the context
+     * @return false otherwise
+     */
+    bool load_existing_context(
+        std::filesystem::path start = std::filesystem::current_path());
+
+    /**
+     * @brief Create a Boo context
+     *
+     * @param dir the directory to create the repository in
+     * @return true if created a new context
+     * @return false otherwise
+     */
+    bool create_context(
+        std::filesystem::path dir = std::filesystem::current_path());
+
+    /**
+     * @brief Visits every entry of the working tree, skipping the .boo
+     * directory
+     *
+     * @param visit called for each entry
+     * @param start the directory to walk (the whole working tree if empty)
+     */
+    void walk_working_tree(
+        std::function<void(const std::filesystem::directory_entry&)> visit,
+        std::filesystem::path start = {});
+
+    /**
+     * @brief Visits entries of the working tree, skipping the .boo directory,
+     * until visit returns false
+     *
+     * @param visit called for each entry, returning false to stop
+     * @param start the directory to walk (the whole working tree if empty)
+     * @return true if every entry was visited
+     * @return false if visit stopped the walk
+     */
+    bool walk_working_tree_until(
+        std::function<bool(const std::filesystem::directory_entry&)> visit,
+        std::filesystem::path start = {});
+
+    /**
+     * @brief Reads a whole file
+     *
+     * @param path the file
+     * @param data set to the file's contents
+     * @param trace_args arguments for the read's trace span
+     * @return true if the file could be read
+     * @return false otherwise
+     */
+    bool read_file(const std::filesystem::path& path, std::string& data,
+                   const std::string& trace_args = "");
+
+    /**
+     * @brief Computes the content digest (sha_obj) a commit stores for a file
+     *
+     * @param path the file
+     * @param digest set to the digest
+     * @return true if the file could be read
+     * @return false otherwise
+     */
+    bool digest_file(const std::filesystem::path& path, std::string& digest);
+
+    /**
+     * @brief Hashes one file with the fast, change detecting hash (not the
+     * digest stored by commits), reusing the cached hash if its mtime and
+     * size are unchanged
+     *
+     * @param path the file
+     * @param mtime the file's last write time
+     * @param size the file's size
+     * @param hash set to the file's hash
+     * @return true if the file could be hashed
+     * @return false otherwise
+     */
+    bool hash_file(const std::filesystem::path& path,
+                   std::filesystem::file_time_type mtime, uintmax_t size,
+                   std::string& hash);
+
+    /**
+     * @brief Uses a file system monitor to limit later scans to the paths it
+     * reports as changed. The next scan is always a full one.
+     *
+     * @param monitor the monitor (not owned), or nullptr to stop using one
+     */
+    void set_monitor(fs_monitor* monitor);
+
+    /**
+     * @brief Updates the hashes of the previous scan for only the paths the
+     * monitor saw change
+     *
+     * @return true if the hashes are up to date
+     * @return false if a full scan is needed (no monitor, no previous scan,
+     * or the monitor lost events)
+     */
+    bool rescan_changed_paths();
+
+    /**
+     * @brief does a hash of each of the files. Files whose mtime and size
+     * match the previous scan reuse their cached hash, and with a monitor
+     * only changed paths are revisited.
+     *
+     * @return const std::unordered_map<std::string, std::string>& a map of the
+     * current hashes, valid until the next scan
+     *
+     */
+    const std::unordered_map<std::string, std::string>&
+    calculate_current_hashes();
+
+    /**
+     * @brief Hashes only the files a filter selects, walking only the parts
+     * of the tree it can select. Unlike calculate_current_hashes, the result
+     * is not kept as the current scan.
+     *
+     * @param filter the filter (everything if empty)
+     * @return std::unordered_map<std::string, std::string> the hashes of the
+     * selected files
+     */
+    std::unordered_map<std::string, std::string> calculate_hashes(
+        const path_filter& filter);
+
+    /**
+     * @brief Whether the selected files differ from HEAD. Stops at the first
+     * new or changed file, only hashing files whose cached hash is stale.
+     *
+     * @param filter the files to check (everything if empty)
+     * @return true if a file was created, modified or deleted
+     * @return false otherwise
+     */
+    bool is_dirty(const path_filter& filter);
+
+    /**
+     * @brief Creates a commit. Contingent on hashes being calculated
+     * beforehand. Digests are only computed for files whose fast hash differs
+     * from the parent commit's (the commit hash covers every file's path and
+     * digest, plus the time)
+     *
+     * @param message the commit message
+     * @return true if commit was successful
+     * @return false otherwise
+     */
+    bool commit(std::string message);
+
+    /**
+     * @brief Searches the files of some commits. Files are grouped by fast
+     * hash, each distinct content is searched once across a thread pool
+     * (mapped, not read), and its matches are then reported under every
+     * commit and path it appears in.
+     *
+     * @param search the pattern
+     * @param commits the commits to search
+     * @param indexed whether to skip the contents the trigram index (see
+     * BooTrigramIndex) rules out, creating the index and adding whatever
+     * contents it lacks first
+     * @return std::vector<grep_match_t> the matching lines, by commit (in the
+     * order given), then path and line
+     */
+    std::vector<grep_match_t> grep(const text_search& search,
+                                   const std::vector<std::string>& commits,
+                                   bool indexed = false);
+
+    /**
+     * @brief Logs a commit to the end of the log
+     *
+     * @param commit_hash
+     * @param message
+     * @return true if the commit was logged
+     * @return false if the log could not be written
+     */
+    bool log_commit(std::string commit_hash, std::string message);
+
+    /**
+     * @brief Get the meta filename of commit object
+     *
+     * @param commit the commit hash
+     * @return std::filesystem::path the path to the meta file
+     */
+    std::filesystem::path get_meta_file_of_commit(std::string commit);
+
+    /**
+     * @brief Gets the filepath to the log file
+     *
+     * @return std::string the log filepath
+     */
+    std::string get_log_file();
+
+    /**
+     * @brief Parses the log file into a list of commits arranged
+     * chronologically
+     *
+     * @return std::vector<commit> the commits
+     */
+    std::vector<commit_t> parse_log();
+
+    /**
+     * @brief Visits commits newest first without reading the whole log
+     *
+     * @param visit called per commit, returning false to stop
+     * @param skip the number of newest commits to pass over first
+     */
+    void walk_log(std::function<bool(const commit_t&)> visit, size_t skip = 0);
+
+    /**
+     * @brief Visits, newest first, only the commits that changed a file or
+     * directory. Each commit's changed-path filter (see BooChangedPaths)
+     * rules out almost every other commit without reading its manifest; the
+     * manifests of the commits it matches are compared to confirm. Commits
+     * made before filters were kept are compared to the commit before them
+     * in the log, and their filters written for next time.
+     *
+     * @param paths files or directories relative to the repository root
+     * @param visit called per commit and the parent it was compared to,
+     * returning false to stop
+     * @param skip the number of newest matching commits to pass over first
+     */
+    void walk_path_log(
+        const std::vector<std::string>& paths,
+        std::function<bool(const commit_t&, const std::string&)> visit,
+        size_t skip = 0);
+
+    /**
+     * @brief Visits commits newest first, each with the commit before it in
+     * the log (the parent of commits made in order; empty for the oldest)
+     *
+     * @param visit called per commit and the one before it, returning false
+     * to stop
+     * @param skip the number of newest commits to pass over first
+     */
+    void walk_log_pairs(
+        std::function<bool(const commit_t&, const std::string&)> visit,
+        size_t skip = 0);
+
+    /**
+     * @brief The repository's trigram index of file contents
+     *
+     */
+    BooTrigramIndex open_trigram_index();
+
+    /**
+     * @brief The repository's change summaries, to look commits up in with
+     * commit_stats (one object per walk, so consecutive lookups are cheap)
+     *
+     */
+    BooCommitStats open_commit_stats();
+
+    /**
+     * @brief A commit's change summary. Summaries are stored when committing;
+     * commits made before they were kept are summarized against parent, and
+     * the summary stored for next time.
+     *
+     * @param summaries the repository's summaries
+     * @param commit the commit hash
+     * @param parent the commit to compare to if there is no summary
+     * @return commit_stats_t the summary
+     */
+    commit_stats_t commit_stats(BooCommitStats& summaries,
+                                const std::string& commit,
+                                const std::string& parent);
+
+    /**
+     * @brief Sets the head to the specified
+     *
+     * @param commit
+     */
+    void set_head(std::string commit);
+
+    /**
+     * @brief Gets the commit hash of the head
+     *
+     * @return std::string the head commit
+     */
+    std::string get_head();
+
+    /**
+     * @brief Gets the path to the .boo directory
+     *
+     * @return std::filesystem::path the .boo directory
+     */
+    std::filesystem::path get_boo_dir();
+
+    /**
+     * @brief Get the head file name
+     *
+     * @return std::string the file name
+     */
+    std::string get_head_file();
+
+    /**
+     * @brief Gets the path to the commit folder
+     *
+     * @param commit the commit hash
+     * @return filesystem::path the path to the folder
+     */
+    std::filesystem::path get_commit_folder(std::string commit);
+
+    /**
+     * @brief Parses a meta file for a commit, if it exists (if it doesn't,
+     * returns empty map).
+     *
+     * @param commit the commit hash
+     * @return std::unordered_map<std::string, std::string> a map from
+     * filepath to fast hash (see hash_file)
+     */
+    std::unordered_map<std::string, std::string> parse_meta_file(
+        std::string commit);
+
+    /**
+     * @brief Whether a commit has a file, from its meta file
+     *
+     * @param commit the commit hash
+     * @param file the file's absolute path
+     */
+    bool has_file(const std::string& commit, const std::string& file);
+
+    /**
+     * @brief Parses the content digests of a commit's files from its meta
+     * file
+     *
+     * @param commit the commit hash
+     * @return std::unordered_map<std::string, std::string> a map from
+     * filepath to digest
+     */
+    std::unordered_map<std::string, std::string> parse_meta_digests(
+        std::string commit);
+
+    /**
+     * @brief Returns whether a commit exists (is in the log's index)
+     *
+     * @param commit the commit hash
+     * @return true if the commit exists
+     * @return false otherwise
+     */
+    bool exists_commit(std::string commit);
+
+    /**
+     * @brief Finds the commits whose hash starts with prefix (see
+     * BooCommitLog::resolve)
+     *
+     * @param prefix the leading digits of the hash, or a full hash
+     * @param limit stop after this many matches
+     * @return std::vector<std::string> the matching hashes
+     */
+    std::vector<std::string> resolve_commit(const std::string& prefix,
+                                            size_t limit = 2);
+
+    /**
+     * @brief Calculates the difference between a from set of hashes (from
+     * path to hash) and a to set of hashes
+     *
+     * @param from_hash the original hashes
+     * @param to_hash the changed hashes
+     * @return changes_t the created, modified and deleted files, sorted, with
+     * identical files renamed or copied (see detect_renames)
+     */
+    changes_t calculate_diffs(
+        const std::unordered_map<std::string, std::string>& from_hash,
+        const std::unordered_map<std::string, std::string>& to_hash);
+
+    /**
+     * @brief Turns each new file with the same content as a deleted file
+     * into a rename, and each other new file with the same content as any
+     * original file into a copy. Empty files are left alone.
+     *
+     * @param changes the changes, updated in place
+     * @param from_hash the original hashes
+     * @param to_hash the changed hashes
+     */
+    void detect_renames(
+        changes_t& changes,
+        const std::unordered_map<std::string, std::string>& from_hash,
+        const std::unordered_map<std::string, std::string>& to_hash);
+
+    /**
+     * @brief Turns the most similar pairs of remaining deleted and new files
+     * into renames, comparing chunk fingerprints (see chunk_fingerprint).
+     * Skipped when there are over a million pairs.
+     *
+     * @param changes the changes, updated in place
+     * @param threshold the least similarity (percent) of a rename
+     * @param from_file where a deleted file's content can be read
+     * @param to_file where a new file's content can be read
+     */
+    void detect_similar_renames(
+        changes_t& changes, int threshold,
+        std::function<std::filesystem::path(const std::string&)> from_file,
+        std::function<std::filesystem::path(const std::string&)> to_file);
+
+    /**
+     * @brief Whether two sets of hashes differ, stopping at the first
+     * difference
+     *
+     * @param from_hash the original hashes
+     * @param to_hash the changed hashes
+     * @return true if any file was created, modified or deleted
+     * @return false otherwise
+     */
+    bool has_changes(
+        const std::unordered_map<std::string, std::string>& from_hash,
+        const std::unordered_map<std::string, std::string>& to_hash);
+
+    /**
+     * @brief resets to a previous commit. The working tree is scanned once,
+     * and that scan is used for both the safety check and the changes.
+     *
+     * @param commit the commit to reset to
+     * @param options force to overwrite any staged changes, swap to swap in
+     * whole top level entries
+     * @param filter if given, only the selected files are scanned, compared
+     * and restored, and HEAD is left alone
+     * @param applied if given, set to the changes made to the working tree
+     * @param report if given, set to what the checkout did
+     * @return true if the reset was successful
+     * @return false otherwise
+     */
+    bool reset(std::string commit, const reset_options_t& options,
+               const path_filter* filter = nullptr,
+               changes_t* applied = nullptr,
+               checkout_report_t* report = nullptr);
+
+   private:
+    /**
+     * @brief The repository's commit log
+     *
+     */
+    BooCommitLog open_log();
+
+    /**
+     * @brief The repository's changed-path filters
+     *
+     */
+    BooChangedPaths open_changed_paths();
+
+    /**
+     * @brief The files that differ between a commit and its parent
+     *
+     * @param commit the commit hash
+     * @param parent the parent's hash, empty if none
+     * @return std::vector<std::string> the files relative to the repository
+     * root
+     */
+    std::vector<std::string> changed_paths(const std::string& commit,
+                                           const std::string& parent);
+
+    /**
+     * @brief Counts the files a commit changed relative to its parent, and
+     * the bytes its copies of them gained and lost
+     *
+     * @param commit the commit hash
+     * @param parent the parent's hash, empty if none
+     * @param after the commit's manifest
+     * @param before the parent's manifest
+     * @return commit_stats_t the summary
+     */
+    commit_stats_t summarize(
+        const std::string& commit, const std::string& parent,
+        const std::unordered_map<std::string, std::string>& after,
+        const std::unordered_map<std::string, std::string>& before);
+
+    /**
+     * @brief Parses a commit's meta file into the meta cache, unless it is
+     * already there. Meta files written before fast hashes were stored are
+     * upgraded in place.
+     *
+     * @param commit the commit hash
+     * @return true if the commit has a meta file
+     * @return false otherwise (the cache is left empty)
+     */
+    bool load_meta_file(const std::string& commit);
+
+    /**
+     * @brief Writes a commit's meta file, sorted by path
+     *
+     * @param commit the commit hash
+     * @param digests the files' digests
+     * @param hashes the files' fast hashes
+     */
+    void write_meta_file(
+        const std::string& commit,
+        const std::unordered_map<std::string, std::string>& digests,
+        const std::unordered_map<std::string, std::string>& hashes);
+
+    std::filesystem::path repo_dir;
+    std::unordered_map<std::string, std::string>
+        file_hashes;  // the file hashes
+    std::unordered_map<std::string, cached_hash_t>
+        hash_cache;  // hashes from the previous scan
+    std::string cached_meta_commit;  // the commit of the last parsed meta file
+    std::unordered_map<std::string, std::string> cached_meta;  // fast hashes
+    std::unordered_map<std::string, std::string> cached_meta_digests;
+    fs_monitor* monitor;  // optional, limits scans to changed paths
+    bool monitor_synced;  // whether file_hashes is a full scan the monitor
+                          // has been tracking changes since
+};
+}  // namespace boo
@@ -0,0 +1,339 @@
+/**
+ * @file daemon.cpp
+ * @author David Xu
+ * @brief Long running boo process serving commands over a Unix socket
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "daemon.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "utils/utils.h"
+
+#define SOCKET_FILE_NAME "daemon.sock"
+#define PROTOCOL_MAGIC 0x424f4f31  // "BOO1"
+#define MAX_MESSAGE_SIZE (1u << 30)
+
+// how long either side waits on a stalled peer mid-request before giving
+// up on the connection
+#define IO_TIMEOUT_SECONDS 5
+// how long a client waits for a command's result (BOO_DAEMON_TIMEOUT
+// overrides it)
+#define REPLY_TIMEOUT_SECONDS 300
+
+#define REQUEST_RUN 0
+#define REQUEST_STOP 1
+#define REQUEST_PING 2
+
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace boo {
+static volatile sig_atomic_t stop_requested = 0;
+
+static void request_stop(int) { stop_requested = 1; }
+
+static bool write_all(int fd, const void* data, size_t size) {
+    const char* bytes = (const char*)data;
+    while (size) {
+        ssize_t n = write(fd, bytes, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        bytes += n;
+        size -= n;
+    }
+    return true;
+}
+
+static bool read_all(int fd, void* data, size_t size) {
+    char* bytes = (char*)data;
+    while (size) {
+        ssize_t n = read(fd, bytes, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        bytes += n;
+        size -= n;
+    }
+    return true;
+}
+
+/* bounds every later read and write on a socket; one that times out fails
+ * with EAGAIN */
+static void set_timeout(int fd, int seconds) {
+    timeval timeout{seconds, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+}
+
+/* how long a client waits for a command's result */
+static int reply_timeout() {
+    const char* env = getenv("BOO_DAEMON_TIMEOUT");
+    int seconds = env ? atoi(env) : 0;
+    return seconds > 0 ? seconds : REPLY_TIMEOUT_SECONDS;
+}
+
+static bool send_u32(int fd, u32 value) {
+    return write_all(fd, &value, sizeof(value));
+}
+
+static bool recv_u32(int fd, u32& value) {
+    return read_all(fd, &value, sizeof(value));
+}
+
+static bool send_string(int fd, const string& s) {
+    return send_u32(fd, s.size()) && write_all(fd, s.data(), s.size());
+}
+
+static bool recv_string(int fd, string& s) {
+    u32 size;
+    if (!recv_u32(fd, size) || size > MAX_MESSAGE_SIZE) return false;
+    s.resize(size);
+    return read_all(fd, s.data(), size);
+}
+
+/**
+ * @brief Fills in a socket address for a socket file. Paths too long for
+ * sun_path are reached through /proc/self/fd/<directory fd> instead.
+ *
+ * @param socket_file the socket file
+ * @param addr the address to fill in
+ * @param dir_fd set to a directory fd the caller must close (or -1)
+ * @return true if the address could be built
+ */
+static bool make_address(const fs::path& socket_file, sockaddr_un& addr,
+                         int& dir_fd) {
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    dir_fd = -1;
+
+    string path = socket_file.string();
+    if (path.size() >= sizeof(addr.sun_path)) {
+        dir_fd = open(socket_file.parent_path().c_str(),
+                      O_PATH | O_DIRECTORY | O_CLOEXEC);
+        if (dir_fd < 0) return false;
+        path = "/proc/self/fd/" + to_string(dir_fd) + "/" +
+               socket_file.filename().string();
+    }
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    return true;
+}
+
+/* connects to a repository's daemon, returning the socket or -1 */
+static int connect_to(const fs::path& boo_dir) {
+    sockaddr_un addr;
+    int dir_fd;
+    if (!make_address(BooDaemon::get_socket_file(boo_dir), addr, dir_fd)) {
+        return -1;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd >= 0 && connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        fd = -1;
+    }
+    if (dir_fd >= 0) close(dir_fd);
+    return fd;
+}
+
+/* sends a request header, returning the connection or -1 */
+static int send_request(const fs::path& boo_dir, u32 type) {
+    int fd = connect_to(boo_dir);
+    if (fd < 0) return -1;
+    set_timeout(fd, IO_TIMEOUT_SECONDS);
+    if (!send_u32(fd, PROTOCOL_MAGIC) || !send_u32(fd, type)) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+BooDaemon::BooDaemon(fs::path boo_dir, executor_t executor)
+    : boo_dir(boo_dir), executor(executor), listen_fd(-1), watched() {}
+
+BooDaemon::~BooDaemon() {
+    if (listen_fd >= 0) {
+        close(listen_fd);
+        fs::remove(get_socket_file(boo_dir));
+    }
+}
+
+void BooDaemon::watch(int fd, function<void()> on_readable) {
+    watched.push_back({fd, on_readable});
+}
+
+fs::path BooDaemon::get_socket_file(fs::path boo_dir) {
+    return boo_dir / SOCKET_FILE_NAME;
+}
+
+bool BooDaemon::is_running(fs::path boo_dir) {
+    int fd = send_request(boo_dir, REQUEST_PING);
+    if (fd < 0) return false;
+    u32 ack = 0;
+    bool running = recv_u32(fd, ack) && ack == PROTOCOL_MAGIC;
+    close(fd);
+    return running;
+}
+
+bool BooDaemon::serve() {
+    fs::path socket_file = get_socket_file(boo_dir);
+    if (is_running(boo_dir)) return false;
+    // left behind by a daemon that did not shut down cleanly
+    fs::remove(socket_file);
+
+    sockaddr_un addr;
+    int dir_fd;
+    if (!make_address(socket_file, addr, dir_fd)) return false;
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    // only the owner may run commands through the socket
+    mode_t old_mask = umask(0077);
+    bool bound =
+        listen_fd >= 0 && bind(listen_fd, (sockaddr*)&addr, sizeof(addr)) == 0;
+    umask(old_mask);
+    if (dir_fd >= 0) close(dir_fd);
+    if (!bound || listen(listen_fd, 64) != 0) {
+        if (listen_fd >= 0) close(listen_fd);
+        listen_fd = -1;
+        return false;
+    }
+
+    // no SA_RESTART, so poll() returns on a signal and the loop can exit
+    struct sigaction action = {};
+    action.sa_handler = request_stop;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    signal(SIGPIPE, SIG_IGN);
+
+    vector<pollfd> fds{{listen_fd, POLLIN, 0}};
+    for (const auto& [fd, _] : watched) fds.push_back({fd, POLLIN, 0});
+
+    while (!stop_requested) {
+        if (poll(fds.data(), fds.size(), -1) < 0) continue;
+
+        for (size_t i = 1; i < fds.size(); ++i) {
+            if (fds[i].revents & POLLIN) watched[i - 1].second();
+        }
+        if (!(fds[0].revents & POLLIN)) continue;
+
+        int fd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) continue;
+        // a stalled client is dropped rather than holding up every other
+        set_timeout(fd, IO_TIMEOUT_SECONDS);
+        bool keep_serving = handle_connection(fd);
+        close(fd);
+        if (!keep_serving) break;
+    }
+    return true;
+}
+
+bool BooDaemon::handle_connection(int fd) {
+    u32 magic, type;
+    if (!recv_u32(fd, magic) || magic != PROTOCOL_MAGIC ||
+        !recv_u32(fd, type)) {
+        return true;
+    }
+
+    if (type == REQUEST_PING) {
+        send_u32(fd, PROTOCOL_MAGIC);
+        return true;
+    }
+    if (type == REQUEST_STOP) {
+        send_u32(fd, PROTOCOL_MAGIC);
+        return false;
+    }
+
+    string cwd;
+    u32 argc;
+    if (!recv_string(fd, cwd) || !recv_u32(fd, argc)) return true;
+    vector<string> args(argc);
+    for (auto& arg : args) {
+        if (!recv_string(fd, arg)) return true;
+    }
+
+    string out, err;
+    int exit_code = -1;
+    if (chdir(cwd.c_str()) != 0) {
+        err = "boo daemon: unable to enter " + cwd + "\n";
+    } else {
+        // commands print to cout/cerr; capture them for the client
+        output_capture capture;
+        exit_code = executor(args);
+        out = capture.out();
+        err = capture.err();
+    }
+
+    send_u32(fd, (u32)exit_code);
+    send_string(fd, out);
+    send_string(fd, err);
+    return true;
+}
+
+bool BooDaemon::forward(fs::path boo_dir, const vector<string>& args,
+                        int& exit_code) {
+    int fd = send_request(boo_dir, REQUEST_RUN);
+    if (fd < 0) return false;
+
+    string cwd = fs::current_path().string();
+    bool sent = send_string(fd, cwd) && send_u32(fd, args.size());
+    for (size_t i = 0; sent && i < args.size(); ++i) {
+        sent = send_string(fd, args[i]);
+    }
+
+    // the command itself may take a while, so the reply gets longer
+    int timeout = reply_timeout();
+    if (sent) set_timeout(fd, timeout);
+    u32 code;
+    string out, err;
+    bool received = sent && recv_u32(fd, code) && recv_string(fd, out) &&
+                    recv_string(fd, err);
+    bool timed_out = !received && (errno == EAGAIN || errno == EWOULDBLOCK);
+    close(fd);
+    // unsent, the daemon never saw the command, so it can safely run here
+    if (!sent) return false;
+    if (!received) {
+        // sent, the daemon may have run it (a commit would land twice if it
+        // were run again)
+        if (timed_out) {
+            cerr << "The daemon did not reply within " << timeout
+                 << " seconds (BOO_DAEMON_TIMEOUT)";
+        } else {
+            cerr << "The daemon did not reply";
+        }
+        cerr << "; the command may or may not have run. Set BOO_NO_DAEMON=1 "
+                "to bypass the daemon"
+             << endl;
+        exit_code = -1;
+        return true;
+    }
+
+    cout << out << flush;
+    cerr << err << flush;
+    exit_code = (int)code;
+    return true;
+}
+
+bool BooDaemon::stop(fs::path boo_dir) {
+    int fd = send_request(boo_dir, REQUEST_STOP);
+    if (fd < 0) return false;
+    u32 ack = 0;
+    bool stopped = recv_u32(fd, ack) && ack == PROTOCOL_MAGIC;
+    close(fd);
+    return stopped;
+}
+}  // namespace boo
@@ -0,0 +1,109 @@
+/**
+ * @file daemon.h
+ * @author David Xu
+ * @brief Long running boo process serving commands over a Unix socket
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace boo {
+class BooDaemon {
+   public:
+    /**
+     * @brief runs one command line (without the program name) and returns
+     * its exit code
+     *
+     */
+    using executor_t = std::function<int(std::vector<std::string>&)>;
+
+    /**
+     * @brief Construct a new daemon for a repository
+     *
+     * @param boo_dir the repository's .boo directory
+     * @param executor runs the commands sent by clients
+     */
+    BooDaemon(std::filesystem::path boo_dir, executor_t executor);
+    ~BooDaemon();
+
+    /**
+     * @brief Calls on_readable whenever fd becomes readable while the daemon
+     * is idle (e.g. to drain a file system monitor)
+     *
+     * @param fd the file descriptor
+     * @param on_readable the callback
+     */
+    void watch(int fd, std::function<void()> on_readable);
+
+    /**
+     * @brief Listens on the repository's socket and serves commands until
+     * stopped by a client or a signal
+     *
+     * @return true if the daemon ran and shut down cleanly
+     * @return false if the socket could not be created
+     */
+    bool serve();
+
+    /**
+     * @brief Gets the socket file of a repository's daemon
+     *
+     * @param boo_dir the repository's .boo directory
+     * @return std::filesystem::path the socket file
+     */
+    static std::filesystem::path get_socket_file(
+        std::filesystem::path boo_dir);
+
+    /**
+     * @brief Whether a daemon is serving the repository
+     *
+     * @param boo_dir the repository's .boo directory
+     */
+    static bool is_running(std::filesystem::path boo_dir);
+
+    /**
+     * @brief Runs a command in the repository's daemon, copying its output
+     * to stdout and stderr
+     *
+     * @param boo_dir the repository's .boo directory
+     * @param args the command line, without the program name
+     * @param exit_code set to the command's exit code
+     * @return true if the command reached the daemon (if no reply came
+     * back, an error is printed and exit_code is -1, as it may have run)
+     * @return false if the command could not be sent (nothing was printed),
+     * so it is safe to run it locally
+     */
+    static bool forward(std::filesystem::path boo_dir,
+                        const std::vector<std::string>& args, int& exit_code);
+
+    /**
+     * @brief Asks the repository's daemon to shut down
+     *
+     * @param boo_dir the repository's .boo directory
+     * @return true if a daemon was stopped
+     * @return false otherwise
+     */
+    static bool stop(std::filesystem::path boo_dir);
+
+   private:
+    /**
+     * @brief Serves one client connection
+     *
+     * @param fd the connection
+     * @return true to keep serving
+     * @return false if the client asked the daemon to stop
+     */
+    bool handle_connection(int fd);
+
+    std::filesystem::path boo_dir;
+    executor_t executor;
+    int listen_fd;
+    std::vector<std::pair<int, std::function<void()>>> watched;
+};
+}  // namespace boo
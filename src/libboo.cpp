@@ -0,0 +1,436 @@
+/**
+ * @file libboo.cpp
+ * @author David Xu
+ * @brief Embeddable boo API: results and errors instead of output and exit
+ * codes
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "libboo.h"
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <optional>
+
+#include "context.h"
+#include "utils/line_diff.h"
+#include "utils/mapped_file.h"
+#include "utils/send_file.h"
+#include "utils/text_search.h"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace boo {
+/**
+ * @brief The state shared by every handle to one repository
+ *
+ */
+struct Repository::state_t {
+    mutex lock;  // held for the whole of every operation
+    BooContext ctx;
+};
+
+/* builds the filter for paths and a sparse checkout pattern file */
+static path_filter make_filter(BooContext& ctx, const vector<string>& paths,
+                               const string& sparse_file) {
+    path_filter filter(ctx.get_boo_dir().parent_path());
+    for (const auto& path : paths) {
+        if (!filter.add_path(path)) {
+            throw boo_error(boo_error::code_t::invalid_path,
+                            path + " is outside the repository");
+        }
+    }
+    if (!sparse_file.empty() && !filter.load_patterns(sparse_file)) {
+        throw boo_error(boo_error::code_t::invalid_path,
+                        "unable to read " + sparse_file);
+    }
+    return filter;
+}
+
+/* the paths a log is limited to, relative to the root; empty for the whole
+ * log */
+static vector<string> log_paths(BooContext& ctx, const vector<string>& paths) {
+    path_filter filter = make_filter(ctx, paths, "");
+    vector<string> rel_paths = filter.relative_paths();
+    // the root itself selects the whole log
+    if (find(rel_paths.begin(), rel_paths.end(), "") != rel_paths.end()) {
+        rel_paths.clear();
+    }
+    return rel_paths;
+}
+
+/* expands an abbreviated commit hash */
+static string resolve_commit(BooContext& ctx, const string& prefix) {
+    vector<string> matches = ctx.resolve_commit(prefix);
+    if (matches.empty()) {
+        throw boo_error(boo_error::code_t::unknown_commit,
+                        "no commit " + prefix);
+    }
+    if (matches.size() > 1) {
+        throw boo_error(boo_error::code_t::ambiguous_commit,
+                        "commit " + prefix + " is ambiguous (" + matches[0] +
+                            ", " + matches[1] + ", ...)");
+    }
+    return matches[0];
+}
+
+/* where a file's content is in a commit, or in the working tree if commit is
+ * empty */
+static fs::path file_in(BooContext& ctx, const string& commit,
+                        const string& file) {
+    if (commit.empty()) return file;
+    size_t prefix = ctx.get_boo_dir().parent_path().string().size() + 1;
+    return ctx.get_commit_folder(commit) / file.substr(prefix);
+}
+
+/* the stored copy of a file in a commit, for show */
+static fs::path shown_file(BooContext& ctx, const string& prefix,
+                           const string& path) {
+    string commit = resolve_commit(ctx, prefix);
+    fs::path root = ctx.get_boo_dir().parent_path();
+    string file = (root / path).lexically_normal().string();
+    if (!ctx.has_file(commit, file)) {
+        throw boo_error(boo_error::code_t::invalid_path,
+                        path + " is not in commit " + commit);
+    }
+    return file_in(ctx, commit, file);
+}
+
+/* the changes from one commit to another, or to the working tree if to is
+ * empty */
+static changes_t diff_commits(BooContext& ctx, const string& from,
+                              const string& to, int rename_threshold) {
+    // compared by fast hash, which covers every byte (sha_obj digests only
+    // see part of each block)
+    changes_t changes =
+        to.empty() ? ctx.calculate_diffs(ctx.parse_meta_file(from),
+                                         ctx.calculate_current_hashes())
+                   : ctx.calculate_diffs(ctx.parse_meta_file(from),
+                                         ctx.parse_meta_file(to));
+    ctx.detect_similar_renames(
+        changes, rename_threshold,
+        [&](const string& file) { return file_in(ctx, from, file); },
+        [&](const string& file) { return file_in(ctx, to, file); });
+    return changes;
+}
+
+boo_error::boo_error(code_t code, const string& message)
+    : runtime_error(message), error_code(code) {}
+
+bool changes_t::empty() const {
+    return new_files.empty() && modified_files.empty() &&
+           deleted_files.empty() && renamed_files.empty() &&
+           copied_files.empty();
+}
+
+commit_t::commit_t(string hash, string message)
+    : message(message), hash(hash) {}
+
+Repository::Repository(shared_ptr<state_t> state) : state(state) {}
+
+shared_ptr<Repository::state_t> Repository::shared_state(const fs::path& root) {
+    // one state per repository root, so handles opened separately (e.g. from
+    // different threads) share the hash cache and the lock
+    static mutex registry_lock;
+    static map<fs::path, weak_ptr<state_t>> registry;
+
+    lock_guard<mutex> guard(registry_lock);
+    auto& entry = registry[fs::weakly_canonical(root)];
+    auto state = entry.lock();
+    if (!state) {
+        state = make_shared<state_t>();
+        state->ctx.load_existing_context(root);
+        entry = state;
+    }
+    return state;
+}
+
+Repository Repository::open(fs::path start) {
+    BooContext probe;
+    if (!probe.load_existing_context(start)) {
+        throw boo_error(boo_error::code_t::not_a_repository,
+                        "no repository in " + fs::absolute(start).string() +
+                            " or any parent directories");
+    }
+    return Repository(shared_state(probe.get_boo_dir().parent_path()));
+}
+
+Repository Repository::init(fs::path dir) {
+    BooContext probe;
+    if (!probe.create_context(dir)) {
+        if (fs::exists(probe.get_boo_dir())) {
+            throw boo_error(boo_error::code_t::already_exists,
+                            "a repository already exists in " +
+                                fs::absolute(dir).string());
+        }
+        throw boo_error(boo_error::code_t::io_error,
+                        "unable to create a repository in " +
+                            fs::absolute(dir).string());
+    }
+    return Repository(shared_state(probe.get_boo_dir().parent_path()));
+}
+
+fs::path Repository::root() const {
+    lock_guard<mutex> guard(state->lock);
+    return state->ctx.get_boo_dir().parent_path();
+}
+
+fs::path Repository::boo_dir() const {
+    lock_guard<mutex> guard(state->lock);
+    return state->ctx.get_boo_dir();
+}
+
+string Repository::head() {
+    lock_guard<mutex> guard(state->lock);
+    return state->ctx.get_head();
+}
+
+string Repository::resolve(const string& prefix) {
+    lock_guard<mutex> guard(state->lock);
+    return resolve_commit(state->ctx, prefix);
+}
+
+status_t Repository::status(const vector<string>& paths,
+                            int rename_threshold) {
+    lock_guard<mutex> guard(state->lock);
+    auto& ctx = state->ctx;
+    path_filter filter = make_filter(ctx, paths, "");
+    string head = ctx.get_head();
+    unordered_map<string, string> limited_hashes;
+    if (!filter.empty()) limited_hashes = ctx.calculate_hashes(filter);
+    const auto& current_hashes =
+        filter.empty() ? ctx.calculate_current_hashes() : limited_hashes;
+    changes_t changes = ctx.calculate_diffs(
+        filter.select(ctx.parse_meta_file(head)), current_hashes);
+    ctx.detect_similar_renames(
+        changes, rename_threshold,
+        [&](const string& file) { return file_in(ctx, head, file); },
+        [](const string& file) { return fs::path(file); });
+    return {head, changes};
+}
+
+bool Repository::is_dirty(const vector<string>& paths) {
+    lock_guard<mutex> guard(state->lock);
+    auto& ctx = state->ctx;
+    return ctx.is_dirty(make_filter(ctx, paths, ""));
+}
+
+changes_t Repository::diff(const string& from, const string& to,
+                           int rename_threshold) {
+    lock_guard<mutex> guard(state->lock);
+    auto& ctx = state->ctx;
+    return diff_commits(ctx, resolve_commit(ctx, from),
+                        to.empty() ? "" : resolve_commit(ctx, to),
+                        rename_threshold);
+}
+
+changes_t Repository::patch(ostream& out, const string& from,
+                            const string& to, size_t context,
+                            int rename_threshold) {
+    lock_guard<mutex> guard(state->lock);
+    auto& ctx = state->ctx;
+    string from_commit = resolve_commit(ctx, from);
+    string to_commit = to.empty() ? "" : resolve_commit(ctx, to);
+    changes_t changes =
+        diff_commits(ctx, from_commit, to_commit, rename_threshold);
+
+    // every changed file as (old name, new name, similarity), empty where it
+    // does not exist, in path order
+    struct file_change_t {
+        string from, to;
+        int similarity;
+        bool copy;
+    };
+    vector<file_change_t> files;
+    for (const auto& file : changes.new_files) {
+        files.push_back({"", file, 0, false});
+    }
+    for (const auto& file : changes.modified_files) {
+        files.push_back({file, file, 0, false});
+    }
+    for (const auto& file : changes.deleted_files) {
+        files.push_back({file, "", 0, false});
+    }
+    for (const auto& rename : changes.renamed_files) {
+        files.push_back({rename.from, rename.to, rename.similarity, false});
+    }
+    for (const auto& copy : changes.copied_files) {
+        files.push_back({copy.from, copy.to, copy.similarity, true});
+    }
+    sort(files.begin(), files.end(),
+         [](const file_change_t& a, const file_change_t& b) {
+             return (a.to.empty() ? a.from : a.to) <
+                    (b.to.empty() ? b.from : b.to);
+         });
+
+    size_t prefix = ctx.get_boo_dir().parent_path().string().size() + 1;
+    for (const auto& file : files) {
+        string old_rel = file.from.empty() ? "" : file.from.substr(prefix);
+        string new_rel = file.to.empty() ? "" : file.to.substr(prefix);
+        out << "diff --boo a/" << (old_rel.empty() ? new_rel : old_rel)
+            << " b/" << (new_rel.empty() ? old_rel : new_rel) << "\n";
+        if (old_rel != new_rel && !old_rel.empty() && !new_rel.empty()) {
+            const char* kind = file.copy ? "copy" : "rename";
+            out << "similarity index " << file.similarity << "%\n"
+                << kind << " from " << old_rel << "\n"
+                << kind << " to " << new_rel << "\n";
+            if (file.similarity == 100) continue;
+        }
+
+        // a side the file is missing from maps nothing, so it reads as empty
+        fs::path old_path, new_path;
+        if (!file.from.empty()) old_path = file_in(ctx, from_commit, file.from);
+        if (!file.to.empty()) new_path = file_in(ctx, to_commit, file.to);
+        mapped_file old_file(old_path);
+        mapped_file new_file(new_path);
+        line_diff file_diff(old_file.view(), new_file.view());
+
+        string old_name = old_rel.empty() ? "/dev/null" : "a/" + old_rel;
+        string new_name = new_rel.empty() ? "/dev/null" : "b/" + new_rel;
+        if (file_diff.is_binary()) {
+            out << "Binary files " << old_name << " and " << new_name
+                << " differ\n";
+            continue;
+        }
+        out << "--- " << old_name << "\n+++ " << new_name << "\n";
+        file_diff.write_unified(out, context);
+    }
+    return changes;
+}
+
+vector<grep_match_t> Repository::grep(const string& pattern,
+                                      const grep_options_t& options) {
+    lock_guard<mutex> guard(state->lock);
+    auto& ctx = state->ctx;
+    optional<text_search> search;
+    try {
+        search.emplace(pattern, options.regex);
+    } catch (const regex_error& e) {
+        throw boo_error(boo_error::code_t::invalid_pattern,
+                        pattern + " is not a valid regular expression (" +
+                            e.what() + ")");
+    }
+
+    vector<string> commits;
+    if (options.all_commits) {
+        ctx.walk_log([&commits](const commit_t& commit) {
+            commits.push_back(commit.hash);
+            return true;
+        });
+    } else {
+        for (const auto& prefix : options.commits) {
+            commits.push_back(resolve_commit(ctx, prefix));
+        }
+        if (commits.empty() && !ctx.get_head().empty()) {
+            commits.push_back(ctx.get_head());
+        }
+    }
+    return ctx.grep(*search, commits, options.indexed);
+}
+
+uint64_t Repository::show(const string& prefix, const string& path,
+                          int out) {
+    lock_guard<mutex> guard(state->lock);
+    fs::path source = shown_file(state->ctx, prefix, path);
+    error_code ec;
+    uint64_t bytes = send_file(source, out, ec);
+    if (ec) {
+        throw boo_error(boo_error::code_t::io_error,
+                        "unable to write " + path + ": " + ec.message());
+    }
+    return bytes;
+}
+
+uint64_t Repository::show(const string& prefix, const string& path,
+                          ostream& out) {
+    lock_guard<mutex> guard(state->lock);
+    mapped_file source(shown_file(state->ctx, prefix, path));
+    if (!source.is_open()) {
+        throw boo_error(boo_error::code_t::io_error,
+                        "unable to read " + path);
+    }
+    out.write(source.data(), source.size());
+    if (!out) {
+        throw boo_error(boo_error::code_t::io_error,
+                        "unable to write " + path);
+    }
+    return source.size();
+}
+
+string Repository::commit(const string& message) {
+    lock_guard<mutex> guard(state->lock);
+    auto& ctx = state->ctx;
+    ctx.calculate_current_hashes();
+    if (!ctx.commit(message)) {
+        throw boo_error(boo_error::code_t::io_error,
+                        "unable to write the commit");
+    }
+    return ctx.get_head();
+}
+
+vector<commit_t> Repository::log() {
+    lock_guard<mutex> guard(state->lock);
+    return state->ctx.parse_log();
+}
+
+void Repository::log(function<bool(const commit_t&)> visit, size_t skip,
+                     const vector<string>& paths) {
+    lock_guard<mutex> guard(state->lock);
+    auto& ctx = state->ctx;
+    vector<string> rel_paths = log_paths(ctx, paths);
+    if (rel_paths.empty()) {
+        ctx.walk_log(visit, skip);
+        return;
+    }
+    ctx.walk_path_log(
+        rel_paths,
+        [&visit](const commit_t& commit, const string&) {
+            return visit(commit);
+        },
+        skip);
+}
+
+void Repository::log_stats(
+    function<bool(const commit_t&, const commit_stats_t&)> visit, size_t skip,
+    const vector<string>& paths) {
+    lock_guard<mutex> guard(state->lock);
+    auto& ctx = state->ctx;
+    vector<string> rel_paths = log_paths(ctx, paths);
+    BooCommitStats summaries = ctx.open_commit_stats();
+    auto with_stats = [&](const commit_t& commit, const string& parent) {
+        return visit(commit, ctx.commit_stats(summaries, commit.hash, parent));
+    };
+    if (rel_paths.empty()) {
+        ctx.walk_log_pairs(with_stats, skip);
+    } else {
+        ctx.walk_path_log(rel_paths, with_stats, skip);
+    }
+}
+
+changes_t Repository::reset(const string& prefix,
+                            const reset_options_t& options,
+                            checkout_report_t* report) {
+    lock_guard<mutex> guard(state->lock);
+    auto& ctx = state->ctx;
+    string commit = resolve_commit(ctx, prefix);
+
+    path_filter filter = make_filter(ctx, options.paths, options.sparse_file);
+
+    changes_t changes;
+    if (!ctx.reset(commit, options, &filter, &changes, report)) {
+        throw boo_error(boo_error::code_t::dirty_working_tree,
+                        "the working tree has uncommitted changes");
+    }
+    return changes;
+}
+
+void Repository::set_monitor(fs_monitor* monitor) {
+    lock_guard<mutex> guard(state->lock);
+    state->ctx.set_monitor(monitor);
+}
+}  // namespace boo
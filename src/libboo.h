@@ -0,0 +1,410 @@
+/**
+ * @file libboo.h
+ * @author David Xu
+ * @brief Embeddable boo API: results and errors instead of output and exit
+ * codes
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace boo {
+class fs_monitor;
+
+/**
+ * @brief representation of a boo commit
+ *
+ */
+struct commit_t {
+    std::string message;
+    std::string hash;
+
+    /**
+     * @brief Construct a new commit object
+     *
+     * @param hash
+     * @param message
+     */
+    commit_t(std::string hash, std::string message);
+};
+
+/**
+ * @brief Error thrown by the library API
+ *
+ */
+class boo_error : public std::runtime_error {
+   public:
+    enum class code_t {
+        not_a_repository,  // no repository in the directory or its ancestors
+        already_exists,    // init on an existing repository
+        unknown_commit,    // the commit does not exist
+        ambiguous_commit,  // an abbreviated hash matches several commits
+        dirty_working_tree,  // reset would overwrite uncommitted changes
+        io_error,            // the repository could not be read or written
+        invalid_path,  // a path is outside the repository or unreadable
+        invalid_pattern,  // a search pattern is not a valid regex
+    };
+
+    boo_error(code_t code, const std::string& message);
+
+    /**
+     * @brief What went wrong
+     *
+     */
+    code_t code() const { return error_code; }
+
+   private:
+    code_t error_code;
+};
+
+/**
+ * @brief a file that moved (or was copied) between two states
+ *
+ */
+struct rename_t {
+    std::string from;
+    std::string to;
+    int similarity = 100;  // percent of content in common
+};
+
+/**
+ * @brief files that differ between two states, each list sorted (renames and
+ * copies by destination). A renamed file is in neither new_files nor
+ * deleted_files; a copy's destination is not in new_files.
+ *
+ */
+struct changes_t {
+    std::vector<std::string> new_files;
+    std::vector<std::string> modified_files;
+    std::vector<std::string> deleted_files;
+    std::vector<rename_t> renamed_files;
+    std::vector<rename_t> copied_files;  // exact copies of an existing file
+
+    /**
+     * @brief Whether nothing changed
+     *
+     */
+    bool empty() const;
+};
+
+/**
+ * @brief what a commit changed relative to its parent
+ *
+ */
+struct commit_stats_t {
+    uint32_t files_added = 0;
+    uint32_t files_modified = 0;
+    uint32_t files_deleted = 0;
+    uint64_t bytes_added = 0;    // new files, and growth of modified ones
+    uint64_t bytes_removed = 0;  // deleted files, and shrinkage of modified
+};
+
+/**
+ * @brief a line of a committed file that matched a search
+ *
+ */
+struct grep_match_t {
+    std::string commit;
+    std::string path;  // relative to the repository root
+    size_t line;       // from 1, or 0 for a binary file that matched
+    std::string text;  // the line, without its newline
+};
+
+/**
+ * @brief what a search looks through
+ *
+ */
+struct grep_options_t {
+    bool regex = false;        // the pattern is an ECMAScript regex
+    bool all_commits = false;  // every commit in the log
+    // otherwise these commits (or unambiguous prefixes), or HEAD if none
+    std::vector<std::string> commits;
+    // only search the files the trigram index cannot rule out (the index is
+    // created on first use, and then kept up to date by every commit)
+    bool indexed = false;
+};
+
+/**
+ * @brief what a reset did to the working tree
+ *
+ */
+struct checkout_report_t {
+    uint64_t files_written = 0;
+    uint64_t files_removed = 0;
+    uint64_t files_renamed = 0;  // moved in place instead of rewritten
+    uint64_t directories_created = 0;
+    uint64_t bytes_written = 0;
+    uint64_t fallbacks = 0;  // operations retried serially after failing
+    uint64_t entries_swapped = 0;  // top level entries exchanged whole
+    unsigned threads = 1;
+    double seconds = 0;
+};
+
+/**
+ * @brief how a reset is carried out
+ *
+ */
+struct reset_options_t {
+    bool force = false;  // overwrite uncommitted changes
+    bool swap = false;   // swap in whole top level entries (see BooCheckout)
+    // when either is given, only the selected files are scanned, compared and
+    // restored, and HEAD does not move
+    std::vector<std::string> paths;  // files or directories
+    std::string sparse_file;  // sparse checkout patterns (see path_filter)
+};
+
+/**
+ * @brief the working tree compared to HEAD
+ *
+ */
+struct status_t {
+    std::string head;
+    changes_t changes;
+};
+
+/**
+ * @brief A handle to a repository. Handles are cheap to copy, and every handle
+ * to the same repository in a process shares its state (hash cache, parsed
+ * manifests) and a lock, so they may be used concurrently from any thread.
+ *
+ */
+class Repository {
+   public:
+    /**
+     * @brief Opens the repository in start or its closest ancestor
+     *
+     * @param start the directory to start searching from
+     * @return Repository the repository
+     * @throws boo_error not_a_repository
+     */
+    static Repository open(
+        std::filesystem::path start = std::filesystem::current_path());
+
+    /**
+     * @brief Creates a repository
+     *
+     * @param dir the directory to create it in
+     * @return Repository the new repository
+     * @throws boo_error already_exists or io_error
+     */
+    static Repository init(
+        std::filesystem::path dir = std::filesystem::current_path());
+
+    /**
+     * @brief The directory containing .boo
+     *
+     */
+    std::filesystem::path root() const;
+
+    /**
+     * @brief The repository's .boo directory
+     *
+     */
+    std::filesystem::path boo_dir() const;
+
+    /**
+     * @brief The HEAD commit, or empty if nothing has been committed
+     *
+     */
+    std::string head();
+
+    /**
+     * @brief Expands an abbreviated commit hash
+     *
+     * @param prefix the leading digits of a commit hash, or a full hash
+     * @return std::string the full hash of the only commit it matches
+     * @throws boo_error unknown_commit or ambiguous_commit
+     */
+    std::string resolve(const std::string& prefix);
+
+    /**
+     * @brief Compares the working tree to HEAD
+     *
+     * @param paths if given, only files under these files or directories
+     * are scanned and compared
+     * @param rename_threshold if nonzero, deleted and new files at least this
+     * similar (percent) are also reported as renames (identical ones always
+     * are)
+     * @return status_t the changes since HEAD
+     * @throws boo_error invalid_path
+     */
+    status_t status(const std::vector<std::string>& paths = {},
+                    int rename_threshold = 0);
+
+    /**
+     * @brief Whether the working tree differs from HEAD, stopping at the
+     * first difference found
+     *
+     * @param paths if given, only files under these files or directories
+     * are scanned and compared
+     * @throws boo_error invalid_path
+     */
+    bool is_dirty(const std::vector<std::string>& paths = {});
+
+    /**
+     * @brief Compares a commit to another commit, using only their stored
+     * manifests (the working tree is not read), or to the working tree
+     *
+     * @param from the older commit (or an unambiguous prefix of its hash)
+     * @param to the newer commit (or an unambiguous prefix of its hash), or
+     * empty for the working tree
+     * @param rename_threshold as for status
+     * @return changes_t the changes from one to the other
+     * @throws boo_error unknown_commit or ambiguous_commit
+     */
+    changes_t diff(const std::string& from, const std::string& to = "",
+                   int rename_threshold = 0);
+
+    /**
+     * @brief Like diff, but also writes a unified line diff of every changed
+     * file (see line_diff), in path order
+     *
+     * @param out the stream to write the diffs to
+     * @param from the older commit (or an unambiguous prefix of its hash)
+     * @param to the newer commit (or an unambiguous prefix of its hash), or
+     * empty for the working tree
+     * @param context the unchanged lines shown around each change
+     * @param rename_threshold as for status
+     * @return changes_t the changes from one to the other
+     * @throws boo_error unknown_commit or ambiguous_commit
+     */
+    changes_t patch(std::ostream& out, const std::string& from,
+                    const std::string& to = "", size_t context = 3,
+                    int rename_threshold = 0);
+
+    /**
+     * @brief Searches committed files for a pattern. Each distinct file
+     * content (by fast hash) referenced by the selected commits is searched
+     * once, in parallel, and its matches reported for every commit and path
+     * it appears under, so searching history costs as much as its unique
+     * content rather than its length.
+     *
+     * @param pattern the literal string (or regex) to find
+     * @param options what to search
+     * @return std::vector<grep_match_t> the matching lines, by commit (in
+     * the order given, newest first for all_commits), then path and line
+     * @throws boo_error unknown_commit, ambiguous_commit or invalid_pattern
+     */
+    std::vector<grep_match_t> grep(const std::string& pattern,
+                                   const grep_options_t& options = {});
+
+    /**
+     * @brief Writes a file as it is in a commit to a descriptor, straight
+     * from the commit's stored copy (see send_file), without a checkout
+     *
+     * @param commit the commit hash (or an unambiguous prefix of it)
+     * @param path the file, relative to the repository root
+     * @param out the descriptor to write to
+     * @return uint64_t the number of bytes written
+     * @throws boo_error unknown_commit, ambiguous_commit, invalid_path (the
+     * commit has no such file) or io_error
+     */
+    uint64_t show(const std::string& commit, const std::string& path,
+                  int out);
+
+    /**
+     * @brief Writes a file as it is in a commit to a stream (for output that
+     * is not a descriptor, such as captured output), through a mapping of
+     * the commit's stored copy
+     *
+     * @param commit the commit hash (or an unambiguous prefix of it)
+     * @param path the file, relative to the repository root
+     * @param out the stream to write to
+     * @return uint64_t the number of bytes written
+     * @throws boo_error unknown_commit, ambiguous_commit, invalid_path (the
+     * commit has no such file) or io_error
+     */
+    uint64_t show(const std::string& commit, const std::string& path,
+                  std::ostream& out);
+
+    /**
+     * @brief Commits the working tree and moves HEAD to the new commit
+     *
+     * @param message the commit message
+     * @return std::string the new commit's hash
+     * @throws boo_error io_error
+     */
+    std::string commit(const std::string& message);
+
+    /**
+     * @brief The commit log, oldest first
+     *
+     */
+    std::vector<commit_t> log();
+
+    /**
+     * @brief Visits the commit log newest first, reading only as much of it
+     * as is visited. The repository is locked throughout, so visit must not
+     * use it.
+     *
+     * @param visit called per commit, returning false to stop
+     * @param skip the number of newest commits to pass over first
+     * @param paths if given, only the commits that changed one of these files
+     * or directories are visited (and skipped), found through per-commit
+     * filters of the paths each commit changed
+     * @throws boo_error invalid_path
+     */
+    void log(std::function<bool(const commit_t&)> visit, size_t skip = 0,
+             const std::vector<std::string>& paths = {});
+
+    /**
+     * @brief Like log, but also passes each commit's change summary. The
+     * summaries are computed when committing, so this only reads them.
+     *
+     * @param visit called per commit, returning false to stop
+     * @param skip the number of newest commits to pass over first
+     * @param paths as for log
+     * @throws boo_error invalid_path
+     */
+    void log_stats(
+        std::function<bool(const commit_t&, const commit_stats_t&)> visit,
+        size_t skip = 0, const std::vector<std::string>& paths = {});
+
+    /**
+     * @brief Resets the working tree to a commit and moves HEAD to it. Files
+     * the commit has under another name are renamed rather than rewritten.
+     *
+     * @param commit the commit hash (or an unambiguous prefix of it)
+     * @param options how to reset
+     * @param report if given, set to what the checkout did
+     * @return changes_t the changes applied to the working tree
+     * @throws boo_error unknown_commit, ambiguous_commit, dirty_working_tree
+     * or invalid_path
+     */
+    changes_t reset(const std::string& commit,
+                    const reset_options_t& options = {},
+                    checkout_report_t* report = nullptr);
+
+    /**
+     * @brief Limits later scans to the paths the monitor reports as changed
+     *
+     * @param monitor the monitor (not owned), or nullptr to stop using one
+     */
+    void set_monitor(fs_monitor* monitor);
+
+   private:
+    struct state_t;
+    Repository(std::shared_ptr<state_t> state);
+
+    /**
+     * @brief Gets the state of the repository at root, creating it if no
+     * handle to the repository is open
+     *
+     */
+    static std::shared_ptr<state_t> shared_state(
+        const std::filesystem::path& root);
+
+    std::shared_ptr<state_t> state;
+};
+}  // namespace boo
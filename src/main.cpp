@@ -0,0 +1,21 @@
+/**
+ * @file main.cpp
+ * @author David Xu
+ * @brief boo command line entry point
+ * @version 0.1
+ * @date 2023-04-20
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include "boo.h"
+
+using namespace boo;
+
+int main(int argc, char* argv[]) {
+    Boo boo;
+    int exit_code;
+    // status, log and commit are served by the daemon when one is running
+    if (boo.forward_to_daemon(argc, argv, exit_code)) return exit_code;
+    return boo.run(argc, argv);
+}
@@ -0,0 +1,71 @@
+/**
+ * @file grep_index_test.cpp
+ * @author David Xu
+ * @brief Checks that indexed searches find what full scans find, including
+ * for regular expressions with escapes
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <stdlib.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "../libboo.h"
+
+using namespace std;
+using namespace boo;
+namespace fs = std::filesystem;
+
+static int failures = 0;
+
+/* checks that a search finds the expected number of lines, indexed or not */
+static void expect_matches(Repository& repo, const string& pattern,
+                           size_t expected) {
+    for (bool indexed : {false, true}) {
+        grep_options_t options;
+        options.regex = true;
+        options.indexed = indexed;
+        size_t found = repo.grep(pattern, options).size();
+        if (found != expected) {
+            cerr << "FAIL: " << pattern << (indexed ? " (indexed)" : "")
+                 << " matched " << found << " lines, expected " << expected
+                 << endl;
+            ++failures;
+        }
+    }
+}
+
+int main() {
+    string dir_name = (fs::temp_directory_path() / "boo-test-XXXXXX").string();
+    if (!mkdtemp(dir_name.data())) return 1;
+    fs::path dir = dir_name;
+
+    Repository repo = Repository::init(dir);
+    ofstream(dir / "letters") << "ABC\nxyz\n";
+    ofstream(dir / "other") << "nothing to see\n";
+    repo.commit("first");
+
+    // the first indexed search creates the index
+    expect_matches(repo, "ABC", 1);
+    expect_matches(repo, "A\\x42C", 1);
+    expect_matches(repo, "\\x41BC", 1);
+    expect_matches(repo, "A\\u0042C", 1);
+    expect_matches(repo, "\\x41BD", 0);
+
+    // and commits add to it from then on
+    ofstream(dir / "more") << "xABCx\n";
+    repo.commit("second");
+    expect_matches(repo, "A\\x42C", 2);
+    expect_matches(repo, "x\\x79z", 1);
+
+    fs::remove_all(dir);
+    if (failures) return 1;
+    cout << "grep_index_test: ok" << endl;
+    return 0;
+}
@@ -0,0 +1,53 @@
+/**
+ * @file text_search_test.cpp
+ * @author David Xu
+ * @brief Checks that the required literal of a pattern never rules out a
+ * match
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <iostream>
+#include <string>
+
+#include "../utils/text_search.h"
+
+using namespace std;
+using namespace boo;
+
+static int failures = 0;
+
+/* checks that a pattern finds the expected number of lines in a text */
+static void expect_matches(const string& pattern, bool regex,
+                           const string& text, size_t expected) {
+    text_search search(pattern, regex);
+    size_t found = search.search(text);
+    if (found != expected) {
+        cerr << "FAIL: " << pattern << " (literal \"" << search.required()
+             << "\") matched " << found << " lines, expected " << expected
+             << endl;
+        ++failures;
+    }
+}
+
+int main() {
+    string text = "ABC\nxyz\nA\nBC\n";
+
+    expect_matches("ABC", false, text, 1);
+    expect_matches("A.C", true, text, 1);
+    // escaped character codes are not the digits they are spelled with
+    expect_matches("\\x41BC", true, text, 1);
+    expect_matches("A\\x42C", true, text, 1);
+    expect_matches("A\\u0042C", true, text, 1);
+    expect_matches("\\x41\\x42\\x43", true, text, 1);
+    expect_matches("x\\x79z", true, text, 1);
+    expect_matches("\\x41BD", true, text, 0);
+    // escaped punctuation is the character itself
+    expect_matches("\\.", true, "a.b\nab\n", 1);
+
+    if (failures) return 1;
+    cout << "text_search_test: ok" << endl;
+    return 0;
+}
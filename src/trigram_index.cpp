@@ -0,0 +1,429 @@
+/**
+ * @file trigram_index.cpp
+ * @author David Xu
+ * @brief Trigram index of committed file contents for fast searches
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "trigram_index.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+#include "utils/line_diff.h"
+#include "utils/mapped_file.h"
+#include "utils/stats.h"
+#include "utils/trace.h"
+
+#define SEGMENT_MAGIC "BOOTRI01"
+#define MAGIC_SIZE 8
+#define SEGMENT_EXTENSION ".seg"
+// larger contents are skipped (they are searched directly)
+#define MAX_INDEXED_SIZE (1024 * 1024)
+// a content flag: binary or too large, so it was not indexed
+#define SKIPPED 1
+
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace boo {
+/**
+ * @brief the start of a segment, followed by the content table, the trigram
+ * table and the posting lists
+ *
+ */
+struct segment_header_t {
+    char magic[MAGIC_SIZE];
+    u32 contents;
+    u32 trigrams;
+};
+
+/**
+ * @brief one indexed content; its position in the table is its id
+ *
+ */
+struct content_entry_t {
+    u64 hash;
+    u32 flags;
+    u32 reserved;
+};
+
+/**
+ * @brief one trigram and where its posting list is
+ *
+ */
+struct trigram_entry_t {
+    u32 trigram;
+    u32 count;   // contents in the list
+    u64 offset;  // of the list from the start of the segment
+};
+
+/**
+ * @brief a mapped segment
+ *
+ */
+struct segment_t {
+    const mapped_file* file;
+    const content_entry_t* contents;
+    u32 content_count;
+    const trigram_entry_t* trigrams;
+    u32 trigram_count;
+};
+
+/**
+ * @brief a segment being built
+ *
+ */
+struct segment_data_t {
+    vector<content_entry_t> contents;  // sorted by hash
+    unordered_map<u32, vector<u32>> postings;  // sorted content ids
+};
+
+/* validates a mapped segment */
+static bool open_segment(const mapped_file& file, segment_t& segment) {
+    if (file.size() < sizeof(segment_header_t)) return false;
+    segment_header_t header;
+    memcpy(&header, file.data(), sizeof(header));
+    if (memcmp(header.magic, SEGMENT_MAGIC, MAGIC_SIZE) != 0) return false;
+    size_t tables = sizeof(header) +
+                    header.contents * sizeof(content_entry_t) +
+                    (size_t)header.trigrams * sizeof(trigram_entry_t);
+    if (tables > file.size()) return false;
+    segment.file = &file;
+    segment.contents =
+        reinterpret_cast<const content_entry_t*>(file.data() + sizeof(header));
+    segment.content_count = header.contents;
+    segment.trigrams = reinterpret_cast<const trigram_entry_t*>(
+        segment.contents + header.contents);
+    segment.trigram_count = header.trigrams;
+    return true;
+}
+
+/* a content's id in a segment, or -1 */
+static int64_t find_content(const segment_t& segment, u64 hash) {
+    const content_entry_t* end = segment.contents + segment.content_count;
+    const content_entry_t* entry = lower_bound(
+        segment.contents, end, hash,
+        [](const content_entry_t& e, u64 hash) { return e.hash < hash; });
+    if (entry == end || entry->hash != hash) return -1;
+    return entry - segment.contents;
+}
+
+/* the ids of the contents containing a trigram (none if it is absent or its
+ * list is damaged) */
+static vector<u32> read_postings(const segment_t& segment, u32 trigram) {
+    vector<u32> ids;
+    const trigram_entry_t* end = segment.trigrams + segment.trigram_count;
+    const trigram_entry_t* entry = lower_bound(
+        segment.trigrams, end, trigram,
+        [](const trigram_entry_t& e, u32 trigram) {
+            return e.trigram < trigram;
+        });
+    if (entry == end || entry->trigram != trigram) return ids;
+
+    const u8* data = reinterpret_cast<const u8*>(segment.file->data());
+    size_t size = segment.file->size();
+    size_t pos = entry->offset;
+    u32 id = 0;
+    ids.reserve(entry->count);
+    for (u32 i = 0; i < entry->count; ++i) {
+        // each id is stored as the gap from the previous one
+        u32 delta = 0;
+        for (int shift = 0; pos < size; shift += 7) {
+            u8 byte = data[pos++];
+            delta |= (u32)(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) break;
+        }
+        id += delta;
+        if (id >= segment.content_count) return {};
+        ids.push_back(id);
+    }
+    return ids;
+}
+
+/* writes a segment aside and renames it into place */
+static bool write_segment(const fs::path& path, const segment_data_t& data) {
+    vector<u32> keys;
+    for (const auto& [trigram, _] : data.postings) keys.push_back(trigram);
+    sort(keys.begin(), keys.end());
+
+    segment_header_t header;
+    memcpy(header.magic, SEGMENT_MAGIC, MAGIC_SIZE);
+    header.contents = data.contents.size();
+    header.trigrams = keys.size();
+
+    vector<trigram_entry_t> table;
+    string postings;
+    u64 offset = sizeof(header) +
+                 data.contents.size() * sizeof(content_entry_t) +
+                 keys.size() * sizeof(trigram_entry_t);
+    for (u32 trigram : keys) {
+        const auto& ids = data.postings.at(trigram);
+        table.push_back({trigram, (u32)ids.size(), offset + postings.size()});
+        u32 previous = 0;
+        for (u32 id : ids) {
+            u32 delta = id - previous;
+            previous = id;
+            while (delta >= 0x80) {
+                postings += (char)((delta & 0x7f) | 0x80);
+                delta >>= 7;
+            }
+            postings += (char)delta;
+        }
+    }
+
+    fs::path tmp = path.string() + ".tmp";
+    {
+        ofstream out(tmp, ios::binary | ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(data.contents.data()),
+                  data.contents.size() * sizeof(content_entry_t));
+        out.write(reinterpret_cast<const char*>(table.data()),
+                  table.size() * sizeof(trigram_entry_t));
+        out.write(postings.data(), postings.size());
+        if (!out) return false;
+    }
+    stats::count(counter_t::objects_written);
+    stats::count(counter_t::bytes_written, fs::file_size(tmp));
+    error_code ec;
+    fs::rename(tmp, path, ec);
+    return !ec;
+}
+
+/* the distinct trigrams of a text, sorted; seen is a 2^24 bit scratch set,
+ * left clear */
+static vector<u32> trigrams_of(string_view text, vector<u64>& seen) {
+    vector<u32> trigrams;
+    u32 trigram = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        trigram = ((trigram << 8) | (u8)text[i]) & 0xffffff;
+        if (i < 2) continue;
+        u64& word = seen[trigram / 64];
+        u64 bit = 1ULL << (trigram % 64);
+        if (word & bit) continue;
+        word |= bit;
+        trigrams.push_back(trigram);
+    }
+    for (u32 t : trigrams) seen[t / 64] = 0;
+    sort(trigrams.begin(), trigrams.end());
+    return trigrams;
+}
+
+/* parses a fast hash (16 hex digits) */
+static bool parse_fast_hash(const string& hash, u64& value) {
+    auto [end, ec] =
+        from_chars(hash.data(), hash.data() + hash.size(), value, 16);
+    return ec == errc() && end == hash.data() + hash.size();
+}
+
+BooTrigramIndex::BooTrigramIndex(fs::path dir) : dir(dir) {}
+
+bool BooTrigramIndex::exists() const { return fs::is_directory(dir); }
+
+bool BooTrigramIndex::create() {
+    error_code ec;
+    fs::create_directories(dir, ec);
+    return exists();
+}
+
+bool BooTrigramIndex::add(const vector<pair<string, fs::path>>& contents) {
+    trace_span span("index_trigrams");
+    vector<fs::path> paths = segments();
+    vector<unique_ptr<mapped_file>> files;
+    vector<segment_t> existing;
+    for (const auto& path : paths) {
+        files.push_back(make_unique<mapped_file>(path));
+        segment_t segment;
+        if (open_segment(*files.back(), segment)) existing.push_back(segment);
+    }
+
+    // only contents the index has not seen
+    vector<pair<u64, fs::path>> added;
+    for (const auto& [hash, file] : contents) {
+        u64 value;
+        if (!parse_fast_hash(hash, value)) continue;
+        bool known = false;
+        for (const auto& segment : existing) {
+            if (find_content(segment, value) >= 0) {
+                known = true;
+                break;
+            }
+        }
+        if (!known) added.push_back({value, file});
+    }
+    sort(added.begin(), added.end());
+    added.erase(unique(added.begin(), added.end(),
+                       [](const auto& a, const auto& b) {
+                           return a.first == b.first;
+                       }),
+                added.end());
+    if (added.empty()) return true;
+
+    segment_data_t data;
+    vector<u64> seen(((u64)1 << 24) / 64);
+    for (const auto& [hash, file] : added) {
+        mapped_file content(file);
+        if (!content.is_open()) continue;
+        u32 id = data.contents.size();
+        bool skip = content.size() > MAX_INDEXED_SIZE ||
+                    line_diff::looks_binary(content.view());
+        data.contents.push_back({hash, skip ? SKIPPED : 0u, 0});
+        stats::count(counter_t::files_opened);
+        if (skip) continue;
+        stats::count(counter_t::bytes_read, content.size());
+        for (u32 trigram : trigrams_of(content.view(), seen)) {
+            data.postings[trigram].push_back(id);
+        }
+    }
+    if (data.contents.empty()) return true;
+
+    // named by sequence number, so the names sort oldest first
+    u64 sequence = 1;
+    if (!paths.empty()) {
+        sequence = strtoull(paths.back().stem().c_str(), nullptr, 10) + 1;
+    }
+    char name[32];
+    snprintf(name, sizeof(name), "%016llu" SEGMENT_EXTENSION,
+             (unsigned long long)sequence);
+    files.clear();
+    if (!write_segment(dir / name, data)) return false;
+    merge();
+    return true;
+}
+
+vector<BooTrigramIndex::lookup_t> BooTrigramIndex::lookup(
+    const string& literal, const vector<string>& hashes) {
+    trace_span span("lookup_trigrams");
+    vector<lookup_t> results(hashes.size(), lookup_t::unindexed);
+    vector<u64> values(hashes.size());
+    for (size_t i = 0; i < hashes.size(); ++i) {
+        parse_fast_hash(hashes[i], values[i]);
+    }
+
+    vector<u32> query;
+    if (literal.size() >= 3) {
+        vector<u64> seen(((u64)1 << 24) / 64);
+        query = trigrams_of(literal, seen);
+    }
+
+    for (const auto& path : segments()) {
+        mapped_file file(path);
+        segment_t segment;
+        if (!open_segment(file, segment)) continue;
+
+        // the ids containing every trigram of the literal
+        bool everything = query.empty();
+        vector<u32> candidates;
+        for (size_t i = 0; i < query.size(); ++i) {
+            vector<u32> ids = read_postings(segment, query[i]);
+            if (i == 0) {
+                candidates = std::move(ids);
+            } else {
+                vector<u32> both;
+                set_intersection(candidates.begin(), candidates.end(),
+                                 ids.begin(), ids.end(),
+                                 back_inserter(both));
+                candidates = std::move(both);
+            }
+            if (candidates.empty()) break;
+        }
+
+        for (size_t i = 0; i < values.size(); ++i) {
+            if (results[i] != lookup_t::unindexed) continue;
+            int64_t id = find_content(segment, values[i]);
+            if (id < 0) continue;
+            bool candidate =
+                everything || (segment.contents[id].flags & SKIPPED) ||
+                binary_search(candidates.begin(), candidates.end(), (u32)id);
+            results[i] = candidate ? lookup_t::candidate : lookup_t::absent;
+            stats::count(candidate ? counter_t::cache_misses
+                                   : counter_t::cache_hits);
+        }
+    }
+    return results;
+}
+
+vector<fs::path> BooTrigramIndex::segments() const {
+    vector<fs::path> paths;
+    error_code ec;
+    for (const auto& entry : fs::directory_iterator(dir, ec)) {
+        if (entry.path().extension() == SEGMENT_EXTENSION) {
+            paths.push_back(entry.path());
+        }
+    }
+    sort(paths.begin(), paths.end());
+    return paths;
+}
+
+void BooTrigramIndex::merge() {
+    vector<fs::path> paths = segments();
+    while (paths.size() >= 2) {
+        const fs::path& older_path = paths[paths.size() - 2];
+        const fs::path& newer_path = paths.back();
+        mapped_file older_file(older_path);
+        mapped_file newer_file(newer_path);
+        segment_t older, newer;
+        if (!open_segment(older_file, older) ||
+            !open_segment(newer_file, newer)) {
+            return;
+        }
+        if ((u64)newer.content_count * 2 < older.content_count) return;
+        trace_span span("merge_trigram_segments");
+
+        // the contents of both, sorted, with each side's ids mapped to the
+        // merged ones
+        segment_data_t data;
+        vector<u32> older_ids(older.content_count);
+        vector<u32> newer_ids(newer.content_count);
+        for (u32 i = 0, j = 0; i < older.content_count ||
+                               j < newer.content_count;) {
+            bool take_older =
+                j == newer.content_count ||
+                (i < older.content_count &&
+                 older.contents[i].hash <= newer.contents[j].hash);
+            u32 id = data.contents.size();
+            if (take_older) {
+                // a content in both (an interrupted merge) is kept once
+                if (j < newer.content_count &&
+                    older.contents[i].hash == newer.contents[j].hash) {
+                    newer_ids[j++] = id;
+                }
+                older_ids[i] = id;
+                data.contents.push_back(older.contents[i++]);
+            } else {
+                newer_ids[j] = id;
+                data.contents.push_back(newer.contents[j++]);
+            }
+        }
+        for (const auto& [segment, ids] :
+             {pair{&older, &older_ids}, pair{&newer, &newer_ids}}) {
+            for (u32 t = 0; t < segment->trigram_count; ++t) {
+                u32 trigram = segment->trigrams[t].trigram;
+                auto& merged = data.postings[trigram];
+                size_t middle = merged.size();
+                for (u32 id : read_postings(*segment, trigram)) {
+                    merged.push_back((*ids)[id]);
+                }
+                inplace_merge(merged.begin(), merged.begin() + middle,
+                              merged.end());
+                merged.erase(unique(merged.begin(), merged.end()),
+                             merged.end());
+            }
+        }
+
+        // the merged segment replaces the newer one, so names stay in order
+        if (!write_segment(newer_path, data)) return;
+        error_code ec;
+        fs::remove(older_path, ec);
+        paths.erase(paths.end() - 2);
+    }
+}
+}  // namespace boo
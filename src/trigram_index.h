@@ -0,0 +1,108 @@
+/**
+ * @file trigram_index.h
+ * @author David Xu
+ * @brief Trigram index of committed file contents for fast searches
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "utils/utils.h"
+
+namespace boo {
+/**
+ * @brief An index from every three byte sequence (trigram) to the file
+ * contents containing it. Contents are named by fast hash, so a content is
+ * indexed once however many commits and paths share it, and each commit only
+ * adds the contents it introduced.
+ *
+ * The index is a directory of immutable segments. A segment holds its
+ * contents' hashes (sorted, so a content's position is its id), a sorted
+ * table of trigrams, and for each trigram the ids of the contents containing
+ * it, delta and varint encoded. Each addition writes a new segment, and
+ * segments are merged whenever the newest is at least half the size of the
+ * one before it, so there are O(log n) of them. Queries mmap the segments.
+ *
+ * Binary contents and contents over 1 MiB are recorded as skipped: they are
+ * always candidates, but are never read again to be indexed.
+ *
+ */
+class BooTrigramIndex {
+   public:
+    /**
+     * @brief Whether a content may contain a string
+     *
+     */
+    enum class lookup_t {
+        absent,     // indexed, and lacks a trigram of the string
+        candidate,  // indexed (or skipped), and may contain it
+        unindexed,  // not in the index
+    };
+
+    /**
+     * @brief Construct the index
+     *
+     * @param dir the directory holding the segments
+     */
+    explicit BooTrigramIndex(std::filesystem::path dir);
+
+    /**
+     * @brief Whether the index is kept for this repository (it is created by
+     * the first indexed search)
+     *
+     */
+    bool exists() const;
+
+    /**
+     * @brief Creates the index, empty, if it does not exist
+     *
+     * @return true if the index exists
+     * @return false if it could not be created
+     */
+    bool create();
+
+    /**
+     * @brief Indexes contents not already in the index, as one new segment
+     *
+     * @param contents each content's fast hash and a file holding it
+     * @return true if the segment was written (or nothing was new)
+     * @return false otherwise
+     */
+    bool add(const std::vector<std::pair<std::string, std::filesystem::path>>&
+                 contents);
+
+    /**
+     * @brief Looks contents up for a search
+     *
+     * @param literal a string every match contains (with fewer than three
+     * bytes, every indexed content is a candidate)
+     * @param hashes the contents' fast hashes
+     * @return std::vector<lookup_t> what the index knows of each content
+     */
+    std::vector<lookup_t> lookup(const std::string& literal,
+                                 const std::vector<std::string>& hashes);
+
+   private:
+    /**
+     * @brief The segment files, oldest first
+     *
+     */
+    std::vector<std::filesystem::path> segments() const;
+
+    /**
+     * @brief Merges the newest segments while the newest is at least half
+     * the size of the one before it
+     *
+     */
+    void merge();
+
+    std::filesystem::path dir;
+};
+}  // namespace boo
@@ -0,0 +1,85 @@
+/**
+ * @file chunk_fingerprint.cpp
+ * @author David Xu
+ * @brief Content defined chunk fingerprints for estimating file similarity
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "chunk_fingerprint.h"
+
+#include <algorithm>
+#include <array>
+
+#include "fast_hash.h"
+
+#define MIN_CHUNK 64
+#define MAX_CHUNK 4096
+// a boundary wherever the top bits of the rolling hash are zero, which
+// averages a chunk every 256 bytes past the minimum
+#define BOUNDARY_MASK (0xffull << 56)
+
+using namespace std;
+
+namespace boo {
+/* one random value per byte, the same in every process (splitmix64) */
+static const array<u64, 256>& gear_table() {
+    static const array<u64, 256> table = [] {
+        array<u64, 256> values;
+        u64 state = 0x9e3779b97f4a7c15ull;
+        for (auto& value : values) {
+            u64 z = (state += 0x9e3779b97f4a7c15ull);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            value = z ^ (z >> 31);
+        }
+        return values;
+    }();
+    return table;
+}
+
+chunk_fingerprint::chunk_fingerprint(string_view data)
+    : chunks(), total(data.size()) {
+    const auto& gear = gear_table();
+    size_t start = 0;
+    u64 rolling = 0;
+    for (size_t i = 0; i < data.size(); ++i) {
+        // shifting ages each byte out of the top bits after 64 more
+        rolling = (rolling << 1) + gear[(unsigned char)data[i]];
+        size_t length = i + 1 - start;
+        if ((length >= MIN_CHUNK && (rolling & BOUNDARY_MASK) == 0) ||
+            length >= MAX_CHUNK) {
+            chunks.push_back({fast_hash(data.data() + start, length),
+                              (u32)length});
+            start = i + 1;
+        }
+    }
+    if (start < data.size()) {
+        chunks.push_back({fast_hash(data.data() + start, data.size() - start),
+                          (u32)(data.size() - start)});
+    }
+    sort(chunks.begin(), chunks.end());
+}
+
+int chunk_fingerprint::similarity(const chunk_fingerprint& other) const {
+    if (total + other.total == 0) return 100;
+    // equal hashes have equal lengths, so the sorted lists merge by hash
+    size_t shared = 0;
+    auto a = chunks.begin();
+    auto b = other.chunks.begin();
+    while (a != chunks.end() && b != other.chunks.end()) {
+        if (a->first < b->first) {
+            ++a;
+        } else if (b->first < a->first) {
+            ++b;
+        } else {
+            shared += a->second;
+            ++a;
+            ++b;
+        }
+    }
+    return (int)(200 * shared / (total + other.total));
+}
+}  // namespace boo
@@ -0,0 +1,52 @@
+/**
+ * @file chunk_fingerprint.h
+ * @author David Xu
+ * @brief Content defined chunk fingerprints for estimating file similarity
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+#include <cstddef>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "utils.h"
+
+namespace boo {
+/**
+ * @brief The hashes of a file's content defined chunks. Chunk boundaries come
+ * from a gear rolling hash (so they depend on the bytes around them, not on
+ * their offset), and each chunk is hashed with fast_hash; an insertion or
+ * deletion then only changes the chunks around it, and two versions of a file
+ * share most of their chunks.
+ *
+ */
+class chunk_fingerprint {
+   public:
+    /**
+     * @brief Fingerprints some bytes
+     *
+     * @param data the bytes
+     */
+    explicit chunk_fingerprint(std::string_view data);
+
+    /**
+     * @brief How much of two fingerprinted texts is the same
+     *
+     * @param other the other fingerprint
+     * @return int the percentage of their bytes in chunks they share
+     */
+    int similarity(const chunk_fingerprint& other) const;
+
+    /* the number of bytes fingerprinted */
+    size_t size() const { return total; }
+
+   private:
+    std::vector<std::pair<u64, u32>> chunks;  // (hash, length), sorted
+    size_t total;
+};
+}  // namespace boo
@@ -0,0 +1,107 @@
+/**
+ * @file fast_hash.cpp
+ * @author David Xu
+ * @brief Fast non-cryptographic hash for detecting changed files
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "fast_hash.h"
+
+#include <cstdio>
+#include <cstring>
+
+#define PRIME_1 0x9E3779B185EBCA87ULL
+#define PRIME_2 0xC2B2AE3D27D4EB4FULL
+#define PRIME_3 0x165667B19E3779F9ULL
+#define PRIME_4 0x85EBCA77C2B2AE63ULL
+#define PRIME_5 0x27D4EB2F165667C5ULL
+
+namespace boo {
+static inline u64 rotl64(u64 value, int amount) {
+    return (value << amount) | (value >> (64 - amount));
+}
+
+// unaligned little endian loads
+static inline u64 read64(const u8* ptr) {
+    u64 value;
+    memcpy(&value, ptr, sizeof(value));
+    return value;
+}
+
+static inline u32 read32(const u8* ptr) {
+    u32 value;
+    memcpy(&value, ptr, sizeof(value));
+    return value;
+}
+
+static inline u64 lane_round(u64 acc, u64 input) {
+    acc += input * PRIME_2;
+    acc = rotl64(acc, 31);
+    return acc * PRIME_1;
+}
+
+static inline u64 merge_round(u64 acc, u64 value) {
+    acc ^= lane_round(0, value);
+    return acc * PRIME_1 + PRIME_4;
+}
+
+u64 fast_hash(const void* data, size_t size, u64 seed) {
+    const u8* ptr = (const u8*)data;
+    const u8* end = ptr + size;
+    u64 hash;
+
+    if (size >= 32) {
+        // the lanes do not depend on each other, so they run in parallel
+        u64 v1 = seed + PRIME_1 + PRIME_2;
+        u64 v2 = seed + PRIME_2;
+        u64 v3 = seed;
+        u64 v4 = seed - PRIME_1;
+        for (const u8* limit = end - 32; ptr <= limit; ptr += 32) {
+            v1 = lane_round(v1, read64(ptr));
+            v2 = lane_round(v2, read64(ptr + 8));
+            v3 = lane_round(v3, read64(ptr + 16));
+            v4 = lane_round(v4, read64(ptr + 24));
+        }
+        hash = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+        hash = merge_round(hash, v1);
+        hash = merge_round(hash, v2);
+        hash = merge_round(hash, v3);
+        hash = merge_round(hash, v4);
+    } else {
+        hash = seed + PRIME_5;
+    }
+    hash += size;
+
+    for (; ptr + 8 <= end; ptr += 8) {
+        hash ^= lane_round(0, read64(ptr));
+        hash = rotl64(hash, 27) * PRIME_1 + PRIME_4;
+    }
+    if (ptr + 4 <= end) {
+        hash ^= (u64)read32(ptr) * PRIME_1;
+        hash = rotl64(hash, 23) * PRIME_2 + PRIME_3;
+        ptr += 4;
+    }
+    for (; ptr < end; ++ptr) {
+        hash ^= *ptr * PRIME_5;
+        hash = rotl64(hash, 11) * PRIME_1;
+    }
+
+    // avalanche
+    hash ^= hash >> 33;
+    hash *= PRIME_2;
+    hash ^= hash >> 29;
+    hash *= PRIME_3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+std::string fast_hash_string(const std::string& data) {
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx",
+             (unsigned long long)fast_hash(data.data(), data.size()));
+    return hex;
+}
+}  // namespace boo
@@ -0,0 +1,37 @@
+/**
+ * @file fast_hash.h
+ * @author David Xu
+ * @brief Fast non-cryptographic hash for detecting changed files
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+#include <cstddef>
+#include <string>
+
+#include "utils.h"
+
+namespace boo {
+/**
+ * @brief Hashes a buffer with XXH64 (four independent 64 bit lanes over 32
+ * byte stripes). Many times faster than sha_obj, but only meant to tell
+ * whether content changed, not to name it.
+ *
+ * @param data the bytes
+ * @param size the number of bytes
+ * @param seed the seed
+ * @return u64 the hash
+ */
+u64 fast_hash(const void* data, size_t size, u64 seed = 0);
+
+/**
+ * @brief fast_hash of a string as 16 hex digits
+ *
+ * @param data the bytes
+ * @return std::string the hash
+ */
+std::string fast_hash_string(const std::string& data);
+}  // namespace boo
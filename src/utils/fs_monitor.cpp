@@ -0,0 +1,124 @@
+/**
+ * @file fs_monitor.cpp
+ * @author David Xu
+ * @brief inotify based record of the paths changed under a directory
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "fs_monitor.h"
+
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <cerrno>
+
+#define WATCH_MASK                                                      \
+    (IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB |  \
+     IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF |     \
+     IN_ONLYDIR | IN_EXCL_UNLINK)
+
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace boo {
+fs_monitor::fs_monitor()
+    : fd(-1),
+      root(),
+      ignore(),
+      watches(),
+      changed(),
+      overflowed(false),
+      unwatched(false) {}
+
+fs_monitor::~fs_monitor() {
+    if (fd >= 0) close(fd);
+}
+
+bool fs_monitor::start(fs::path root, fs::path ignore) {
+    fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) return false;
+    this->root = root;
+    this->ignore = ignore;
+    add_watches(root);
+    return true;
+}
+
+void fs_monitor::add_watches(const fs::path& dir) {
+    if (dir == ignore) return;
+
+    int wd = inotify_add_watch(fd, dir.c_str(), WATCH_MASK);
+    if (wd < 0) {
+        // most likely out of watches (ENOSPC); changes under dir would be
+        // missed, so every scan has to be a full one
+        if (errno != ENOENT && errno != ENOTDIR) unwatched = true;
+        return;
+    }
+    watches[wd] = dir;
+
+    error_code ec;
+    for (fs::directory_iterator itr(dir, ec), end; !ec && itr != end;
+         itr.increment(ec)) {
+        if (itr->is_directory(ec) && !itr->is_symlink(ec)) {
+            add_watches(itr->path());
+        }
+    }
+}
+
+void fs_monitor::drain() {
+    if (fd < 0) return;
+
+    alignas(inotify_event) char buffer[64 * 1024];
+    while (true) {
+        ssize_t length = read(fd, buffer, sizeof(buffer));
+        if (length <= 0) break;
+
+        for (char* ptr = buffer; ptr < buffer + length;) {
+            auto* event = (inotify_event*)ptr;
+            ptr += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                overflowed = true;
+                continue;
+            }
+            if (event->mask & IN_IGNORED) {
+                watches.erase(event->wd);
+                continue;
+            }
+
+            auto watch = watches.find(event->wd);
+            if (watch == watches.end()) continue;
+            if (!event->len) {
+                // the directory itself was deleted or moved
+                changed.insert(watch->second.string());
+                continue;
+            }
+
+            fs::path path = watch->second / event->name;
+            if (path == ignore) continue;
+            changed.insert(path.string());
+
+            if ((event->mask & IN_ISDIR) &&
+                (event->mask & (IN_CREATE | IN_MOVED_TO))) {
+                add_watches(path);
+            }
+        }
+    }
+}
+
+bool fs_monitor::take_changes(unordered_set<string>& dirty) {
+    drain();
+    bool complete = fd >= 0 && !overflowed && !unwatched;
+    if (fd >= 0 && overflowed) {
+        // directories created while events were being dropped may not be
+        // watched yet (re-adding an existing watch is a no-op)
+        add_watches(root);
+    }
+    dirty.swap(changed);
+    changed.clear();
+    overflowed = false;
+    return complete;
+}
+}  // namespace boo
@@ -0,0 +1,76 @@
+/**
+ * @file fs_monitor.h
+ * @author David Xu
+ * @brief inotify based record of the paths changed under a directory
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace boo {
+/**
+ * @brief Watches a directory tree and accumulates the paths changed since
+ * the last call to take_changes(). When the kernel queue overflows, or the
+ * tree cannot be fully watched, take_changes() reports that a full rescan is
+ * needed instead.
+ *
+ */
+class fs_monitor {
+   public:
+    fs_monitor();
+    ~fs_monitor();
+
+    fs_monitor(const fs_monitor&) = delete;
+    fs_monitor& operator=(const fs_monitor&) = delete;
+
+    /**
+     * @brief Starts watching every directory under root
+     *
+     * @param root the directory to watch
+     * @param ignore a directory under root to leave unwatched (e.g. .boo)
+     * @return true if the monitor could be started
+     * @return false otherwise
+     */
+    bool start(std::filesystem::path root, std::filesystem::path ignore);
+
+    /**
+     * @brief The inotify fd, readable when events are pending (or -1)
+     *
+     */
+    int get_fd() const { return fd; }
+
+    /**
+     * @brief Reads all pending events without blocking
+     *
+     */
+    void drain();
+
+    /**
+     * @brief Moves the changed paths since the last call into dirty. Changed
+     * directories stand for everything beneath them.
+     *
+     * @param dirty the set to fill
+     * @return true if dirty holds every change
+     * @return false if changes were lost and a full rescan is needed
+     */
+    bool take_changes(std::unordered_set<std::string>& dirty);
+
+   private:
+    void add_watches(const std::filesystem::path& dir);
+
+    int fd;
+    std::filesystem::path root;
+    std::filesystem::path ignore;
+    std::unordered_map<int, std::filesystem::path> watches;  // wd to dir
+    std::unordered_set<std::string> changed;
+    bool overflowed;  // events were lost since the last take_changes()
+    bool unwatched;   // some directory could not be watched at all
+};
+}  // namespace boo
@@ -0,0 +1,269 @@
+/**
+ * @file line_diff.cpp
+ * @author David Xu
+ * @brief Line by line diff of two texts, written as a unified diff
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "line_diff.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "fast_hash.h"
+#include "trace.h"
+
+// bytes checked for NUL when deciding whether a text is binary
+#define BINARY_CHECK_BYTES 8000
+// bounds of the edit distance past which the middle is replaced wholesale
+#define MIN_COST_LIMIT 256
+#define MAX_COST_LIMIT 2048
+
+using namespace std;
+
+namespace boo {
+line_diff::line_diff(string_view old_text, string_view new_text)
+    : old_lines(),
+      new_lines(),
+      deleted(),
+      inserted(),
+      binary(looks_binary(old_text) || looks_binary(new_text)),
+      cutoff(false),
+      has_changes(old_text != new_text) {
+    if (binary || !has_changes) return;
+    trace_span span("line_diff");
+    old_lines = split_lines(old_text);
+    new_lines = split_lines(new_text);
+    compare();
+}
+
+bool line_diff::looks_binary(string_view text) {
+    size_t size = min<size_t>(text.size(), BINARY_CHECK_BYTES);
+    return size > 0 && memchr(text.data(), '\0', size) != nullptr;
+}
+
+vector<line_diff::line_t> line_diff::split_lines(string_view text) {
+    vector<line_t> lines;
+    const char* data = text.data();
+    size_t size = text.size();
+    size_t start = 0;
+    auto add_line = [&lines, data, &start](size_t end) {
+        string_view line(data + start, end - start);
+        lines.push_back({line, fast_hash(line.data(), line.size())});
+        start = end;
+    };
+
+    size_t i = 0;
+#ifdef __SSE2__
+    // sixteen bytes compared at once; each set bit of the mask is a newline
+    const __m128i newline = _mm_set1_epi8('\n');
+    for (; i + 16 <= size; i += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)(data + i));
+        unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline));
+        while (mask) {
+            add_line(i + __builtin_ctz(mask) + 1);
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for (; i < size; ++i) {
+        if (data[i] == '\n') add_line(i + 1);
+    }
+    // the last line has no newline
+    if (start < size) add_line(size);
+    return lines;
+}
+
+void line_diff::compare() {
+    size_t n = old_lines.size();
+    size_t m = new_lines.size();
+    deleted.assign(n, false);
+    inserted.assign(m, false);
+
+    auto same = [](const line_t& a, const line_t& b) {
+        return a.hash == b.hash && a.text == b.text;
+    };
+    size_t prefix = 0;
+    while (prefix < n && prefix < m &&
+           same(old_lines[prefix], new_lines[prefix])) {
+        ++prefix;
+    }
+    size_t suffix = 0;
+    while (suffix < n - prefix && suffix < m - prefix &&
+           same(old_lines[n - 1 - suffix], new_lines[m - 1 - suffix])) {
+        ++suffix;
+    }
+
+    // equal lines get equal ids, so the search compares integers
+    struct line_hash_t {
+        size_t operator()(const line_t& line) const { return line.hash; }
+    };
+    struct line_equal_t {
+        bool operator()(const line_t& a, const line_t& b) const {
+            return a.text == b.text;
+        }
+    };
+    unordered_map<line_t, u32, line_hash_t, line_equal_t> ids;
+    auto to_ids = [&ids, prefix](const vector<line_t>& lines, size_t end) {
+        vector<u32> result;
+        result.reserve(end - prefix);
+        for (size_t i = prefix; i < end; ++i) {
+            auto [id, _] = ids.try_emplace(lines[i], ids.size());
+            result.push_back(id->second);
+        }
+        return result;
+    };
+    vector<u32> a = to_ids(old_lines, n - suffix);
+    vector<u32> b = to_ids(new_lines, m - suffix);
+
+    // Myers: v[k] is the furthest x reached on diagonal k = x - y; the v of
+    // every round is kept to walk the path back
+    int old_size = a.size();
+    int new_size = b.size();
+    int cost_limit = clamp((int)sqrt((double)old_size + new_size),
+                           MIN_COST_LIMIT, MAX_COST_LIMIT);
+    int offset = cost_limit + 1;
+    vector<int> v(2 * offset + 1, 0);
+    vector<vector<int>> rounds;
+    int cost = -1;
+    for (int d = 0; d <= old_size + new_size && cost < 0; ++d) {
+        if (d > cost_limit) break;
+        rounds.emplace_back(v.begin() + offset - d, v.begin() + offset + d + 1);
+        for (int k = -d; k <= d; k += 2) {
+            bool down =
+                k == -d || (k != d && v[offset + k - 1] < v[offset + k + 1]);
+            int x = down ? v[offset + k + 1] : v[offset + k - 1] + 1;
+            int y = x - k;
+            while (x < old_size && y < new_size && a[x] == b[y]) {
+                ++x;
+                ++y;
+            }
+            v[offset + k] = x;
+            if (x == old_size && y == new_size) {
+                cost = d;
+                break;
+            }
+        }
+    }
+
+    if (cost < 0) {
+        // pathological; report the middle as replaced
+        cutoff = true;
+        fill(deleted.begin() + prefix, deleted.end() - suffix, true);
+        fill(inserted.begin() + prefix, inserted.end() - suffix, true);
+        return;
+    }
+
+    int x = old_size;
+    int y = new_size;
+    for (int d = cost; d > 0; --d) {
+        const vector<int>& prev = rounds[d];  // index k + d
+        int k = x - y;
+        bool down = k == -d || (k != d && prev[k - 1 + d] < prev[k + 1 + d]);
+        int prev_k = down ? k + 1 : k - 1;
+        int prev_x = prev[prev_k + d];
+        int prev_y = prev_x - prev_k;
+        while (x > prev_x && y > prev_y) {
+            --x;
+            --y;
+        }
+        if (down) {
+            inserted[prefix + prev_y] = true;
+        } else {
+            deleted[prefix + prev_x] = true;
+        }
+        x = prev_x;
+        y = prev_y;
+    }
+}
+
+void line_diff::write_line(ostream& out, char prefix, string_view line) {
+    out << prefix << line;
+    if (line.empty() || line.back() != '\n') {
+        out << "\n\\ No newline at end of file\n";
+    }
+}
+
+/* formats a hunk range like diff does: "start,length", with the start of an
+ * empty range being the line before it and a length of 1 left out */
+static string hunk_range(size_t start, size_t length) {
+    if (length == 0) return to_string(start) + ",0";
+    if (length == 1) return to_string(start + 1);
+    return to_string(start + 1) + "," + to_string(length);
+}
+
+void line_diff::write_unified(ostream& out, size_t context) const {
+    if (binary || !has_changes) return;
+
+    // runs of changed lines, as [old_begin, old_end) and [new_begin, new_end)
+    struct change_t {
+        size_t old_begin, old_end, new_begin, new_end;
+    };
+    vector<change_t> changes;
+    size_t i = 0;
+    size_t j = 0;
+    size_t n = old_lines.size();
+    size_t m = new_lines.size();
+    while (i < n || j < m) {
+        if ((i < n && deleted[i]) || (j < m && inserted[j])) {
+            change_t change{i, i, j, j};
+            while (i < n && deleted[i]) ++i;
+            while (j < m && inserted[j]) ++j;
+            change.old_end = i;
+            change.new_end = j;
+            changes.push_back(change);
+        } else {
+            ++i;
+            ++j;
+        }
+    }
+
+    // changes closer than twice the context share a hunk
+    for (size_t first = 0; first < changes.size();) {
+        size_t last = first;
+        while (last + 1 < changes.size() &&
+               changes[last + 1].old_begin - changes[last].old_end <=
+                   2 * context) {
+            ++last;
+        }
+
+        // unchanged lines pair up, so the context is the same on both sides
+        size_t before = min(context, changes[first].old_begin);
+        size_t after = min(context, n - changes[last].old_end);
+        size_t old_begin = changes[first].old_begin - before;
+        size_t new_begin = changes[first].new_begin - before;
+        size_t old_end = changes[last].old_end + after;
+        size_t new_end = changes[last].new_end + after;
+        out << "@@ -" << hunk_range(old_begin, old_end - old_begin) << " +"
+            << hunk_range(new_begin, new_end - new_begin) << " @@\n";
+
+        size_t line = old_begin;
+        for (size_t c = first; c <= last; ++c) {
+            for (; line < changes[c].old_begin; ++line) {
+                write_line(out, ' ', old_lines[line].text);
+            }
+            for (size_t k = changes[c].old_begin; k < changes[c].old_end; ++k) {
+                write_line(out, '-', old_lines[k].text);
+            }
+            for (size_t k = changes[c].new_begin; k < changes[c].new_end; ++k) {
+                write_line(out, '+', new_lines[k].text);
+            }
+            line = changes[c].old_end;
+        }
+        for (; line < old_end; ++line) {
+            write_line(out, ' ', old_lines[line].text);
+        }
+        first = last + 1;
+    }
+}
+}  // namespace boo
@@ -0,0 +1,103 @@
+/**
+ * @file line_diff.h
+ * @author David Xu
+ * @brief Line by line diff of two texts, written as a unified diff
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+#include <cstddef>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+#include "utils.h"
+
+namespace boo {
+/**
+ * @brief Diffs two texts line by line. Lines are split with SSE2 newline
+ * scanning and hashed with fast_hash, so comparing lines is comparing
+ * integers. The common prefix and suffix are trimmed, and the rest is diffed
+ * with Myers' algorithm. Once the edit distance passes a cutoff (about the
+ * square root of the line count, between 256 and 2048) the remaining middle
+ * is reported as replaced wholesale, so pathological inputs cost O(N^1.5)
+ * rather than O(N^2); the diff is then correct but not minimal. Texts with a
+ * NUL byte near their start are treated as binary and not diffed.
+ *
+ * The texts must outlive the diff (they are usually mapped_files).
+ *
+ */
+class line_diff {
+   public:
+    /**
+     * @brief Diffs two texts
+     *
+     * @param old_text the old version
+     * @param new_text the new version
+     */
+    line_diff(std::string_view old_text, std::string_view new_text);
+
+    /* whether either text is binary (nothing is diffed then) */
+    bool is_binary() const { return binary; }
+    /* whether the cutoff was hit, so the diff may not be minimal */
+    bool hit_cutoff() const { return cutoff; }
+    /* whether the texts differ */
+    bool changed() const { return has_changes; }
+
+    /**
+     * @brief Writes the hunks (without file headers) in unified format
+     *
+     * @param out the stream
+     * @param context the unchanged lines shown around each change
+     */
+    void write_unified(std::ostream& out, size_t context = 3) const;
+
+    /**
+     * @brief Whether a text looks binary (has a NUL in its first 8000 bytes,
+     * like git)
+     *
+     */
+    static bool looks_binary(std::string_view text);
+
+   private:
+    /**
+     * @brief a line, including its newline if it has one
+     *
+     */
+    struct line_t {
+        std::string_view text;
+        u64 hash;
+    };
+
+    /**
+     * @brief Splits a text into lines and hashes them
+     *
+     */
+    static std::vector<line_t> split_lines(std::string_view text);
+
+    /**
+     * @brief Marks the lines deleted from old_lines and inserted into
+     * new_lines
+     *
+     */
+    void compare();
+
+    /**
+     * @brief Writes a line with a prefix, noting a missing final newline
+     *
+     */
+    static void write_line(std::ostream& out, char prefix,
+                           std::string_view line);
+
+    std::vector<line_t> old_lines;
+    std::vector<line_t> new_lines;
+    std::vector<bool> deleted;   // per old line
+    std::vector<bool> inserted;  // per new line
+    bool binary;
+    bool cutoff;
+    bool has_changes;
+};
+}  // namespace boo
@@ -0,0 +1,48 @@
+/**
+ * @file mapped_file.cpp
+ * @author David Xu
+ * @brief Read only memory mapping of a whole file
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "stats.h"
+
+namespace boo {
+mapped_file::mapped_file(const std::filesystem::path& path)
+    : open(false), bytes(nullptr), length(0) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return;
+    struct stat st;
+    if (fstat(fd, &st) == 0) {
+        open = true;
+        stats::count(counter_t::files_opened);
+        // mmap rejects empty mappings, and there is nothing to map anyway
+        if (st.st_size > 0) {
+            void* mapping =
+                mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) {
+                open = false;
+            } else {
+                bytes = static_cast<const char*>(mapping);
+                length = st.st_size;
+            }
+        }
+    }
+    // the mapping stays valid without the descriptor
+    close(fd);
+}
+
+mapped_file::~mapped_file() {
+    if (bytes) munmap(const_cast<char*>(bytes), length);
+}
+}  // namespace boo
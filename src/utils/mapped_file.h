@@ -0,0 +1,46 @@
+/**
+ * @file mapped_file.h
+ * @author David Xu
+ * @brief Read only memory mapping of a whole file
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+#include <cstddef>
+#include <filesystem>
+#include <string_view>
+
+namespace boo {
+/**
+ * @brief Maps a file read only for as long as it lives. The mapping reflects
+ * the file's size when it was opened; bytes appended later are not visible.
+ *
+ */
+class mapped_file {
+   public:
+    /**
+     * @brief Maps a file
+     *
+     * @param path the file (is_open() is false if it cannot be mapped)
+     */
+    explicit mapped_file(const std::filesystem::path& path);
+    ~mapped_file();
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    /* whether the file could be opened (an empty file is open, with no data) */
+    bool is_open() const { return open; }
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+    std::string_view view() const { return {bytes, length}; }
+
+   private:
+    bool open;
+    const char* bytes;
+    size_t length;
+};
+}  // namespace boo
@@ -0,0 +1,190 @@
+/**
+ * @file path_filter.cpp
+ * @author David Xu
+ * @brief Selects the files of a working tree a command applies to
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "path_filter.h"
+
+#include <fnmatch.h>
+
+#include <algorithm>
+#include <fstream>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace boo {
+/* whether a relative path is dir or beneath it ("" is the root) */
+static bool is_under(const string& path, const string& dir) {
+    return dir.empty() || path == dir ||
+           (path.starts_with(dir) && path[dir.size()] == '/');
+}
+
+path_filter::path_filter(fs::path root)
+    : root(fs::absolute(root).lexically_normal()), paths(), patterns() {}
+
+bool path_filter::add_path(const fs::path& path) {
+    fs::path rel =
+        fs::absolute(path).lexically_normal().lexically_relative(root);
+    string rel_path = rel.string();
+    if (rel.empty() || rel_path == ".." || rel_path.starts_with("../")) {
+        return false;
+    }
+    // the root itself selects everything
+    if (rel_path == "." || rel_path == "./") rel_path = "";
+    while (rel_path.ends_with('/')) rel_path.pop_back();
+    paths.push_back(rel_path);
+    return true;
+}
+
+void path_filter::add_pattern(string pattern) {
+    while (!pattern.empty() && isspace((unsigned char)pattern.back())) {
+        pattern.pop_back();
+    }
+    if (pattern.empty() || pattern[0] == '#') return;
+
+    pattern_t parsed{pattern, false, false, false};
+    if (parsed.glob[0] == '!') {
+        parsed.negated = true;
+        parsed.glob.erase(0, 1);
+    }
+    if (parsed.glob.ends_with('/')) {
+        parsed.directory_only = true;
+        parsed.glob.pop_back();
+    }
+    if (parsed.glob.find('/') != string::npos) {
+        parsed.anchored = true;
+        if (parsed.glob[0] == '/') parsed.glob.erase(0, 1);
+    }
+    if (!parsed.glob.empty()) patterns.push_back(parsed);
+}
+
+bool path_filter::load_patterns(const fs::path& file) {
+    ifstream in(file);
+    if (!in) return false;
+    string line;
+    while (getline(in, line)) add_pattern(line);
+    return true;
+}
+
+bool path_filter::pattern_matches(const pattern_t& pattern,
+                                  const string& rel_path) const {
+    // try the path itself, then each directory above it (a directory
+    // matching selects everything beneath it)
+    for (size_t end = rel_path.size(); end != string::npos && end > 0;
+         end = rel_path.rfind('/', end - 1)) {
+        bool is_directory = end != rel_path.size();
+        if (pattern.directory_only && !is_directory) continue;
+
+        string prefix = rel_path.substr(0, end);
+        const char* subject = prefix.c_str();
+        if (!pattern.anchored) {
+            size_t slash = prefix.rfind('/');
+            if (slash != string::npos) subject += slash + 1;
+        }
+        if (fnmatch(pattern.glob.c_str(), subject, FNM_PATHNAME) == 0) {
+            return true;
+        }
+        if (end == 0) break;
+    }
+    return false;
+}
+
+bool path_filter::matches(const string& file) const {
+    if (empty()) return true;
+    string abs_path = fs::path(file).lexically_normal().string();
+    string root_path = root.string();
+    if (!abs_path.starts_with(root_path + "/")) return false;
+    string rel_path = abs_path.substr(root_path.size() + 1);
+
+    if (!paths.empty()) {
+        bool under_path =
+            any_of(paths.begin(), paths.end(), [&rel_path](const string& path) {
+                return is_under(rel_path, path);
+            });
+        if (!under_path) return false;
+    }
+
+    if (patterns.empty()) return true;
+    bool selected = false;
+    for (const auto& pattern : patterns) {
+        if (pattern_matches(pattern, rel_path)) selected = !pattern.negated;
+    }
+    return selected;
+}
+
+unordered_map<string, string> path_filter::select(
+    const unordered_map<string, string>& hashes) const {
+    if (empty()) return hashes;
+    unordered_map<string, string> selected;
+    for (const auto& [path, hash] : hashes) {
+        if (matches(path)) selected.emplace(path, hash);
+    }
+    return selected;
+}
+
+/* the leading components of a glob that have no wildcards, which everything
+ * it matches lies beneath */
+static string fixed_prefix(const string& glob) {
+    string prefix;
+    for (size_t start = 0; start <= glob.size();) {
+        size_t end = min(glob.find('/', start), glob.size());
+        string component = glob.substr(start, end - start);
+        if (component.find_first_of("*?[\\") != string::npos) break;
+        if (!component.empty()) {
+            prefix += (prefix.empty() ? "" : "/") + component;
+        }
+        start = end + 1;
+    }
+    return prefix;
+}
+
+vector<fs::path> path_filter::roots() const {
+    vector<string> sorted = paths;
+    if (sorted.empty()) sorted.push_back("");
+    if (!patterns.empty()) {
+        // a file must also match a pattern that is not negated, so only what
+        // those can match is scanned; one matching at any depth (no /) needs
+        // the whole tree, an anchored one only its fixed leading directories
+        vector<string> pattern_roots;
+        for (const auto& pattern : patterns) {
+            if (pattern.negated) continue;
+            pattern_roots.push_back(
+                pattern.anchored ? fixed_prefix(pattern.glob) : "");
+        }
+        // the narrower of each path and pattern root, where they overlap
+        vector<string> narrowed;
+        for (const auto& path : sorted) {
+            for (const auto& pattern_root : pattern_roots) {
+                if (is_under(pattern_root, path)) {
+                    narrowed.push_back(pattern_root);
+                } else if (is_under(path, pattern_root)) {
+                    narrowed.push_back(path);
+                }
+            }
+        }
+        sorted = narrowed;
+    }
+    sort(sorted.begin(), sorted.end());
+
+    // drop paths beneath another path; a directory sorts before everything
+    // under it, but not always right before ("a-b" sorts between "a" and
+    // "a/c"), so each path is checked against every kept one
+    vector<string> kept;
+    vector<fs::path> result;
+    for (const auto& path : sorted) {
+        bool nested =
+            any_of(kept.begin(), kept.end(),
+                   [&path](const string& dir) { return is_under(path, dir); });
+        if (nested) continue;
+        kept.push_back(path);
+        result.push_back(path.empty() ? root : root / path);
+    }
+    return result;
+}
+}  // namespace boo
@@ -0,0 +1,118 @@
+/**
+ * @file path_filter.h
+ * @author David Xu
+ * @brief Selects the files of a working tree a command applies to
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace boo {
+/**
+ * @brief A set of paths (files or directories) and sparse checkout patterns.
+ * A file is selected if it is under one of the paths (or no paths were
+ * given) and the last pattern matching it is not negated (or no patterns
+ * were given). An empty filter selects everything.
+ *
+ * Patterns follow .gitignore rules: one per line, # starts a comment, a
+ * leading ! negates, a trailing / only matches directories, and a pattern
+ * containing a / is anchored at the root while one without matches at any
+ * depth. Shell wildcards (*, ?, [...]) do not cross a /.
+ *
+ */
+class path_filter {
+   public:
+    /**
+     * @brief Construct a filter selecting everything
+     *
+     * @param root the working tree the paths and patterns are relative to
+     */
+    path_filter(std::filesystem::path root);
+
+    /**
+     * @brief Limits the filter to a file or directory
+     *
+     * @param path relative to the current directory, or absolute
+     * @return true if the path is inside the root
+     * @return false otherwise (and it is ignored)
+     */
+    bool add_path(const std::filesystem::path& path);
+
+    /**
+     * @brief Adds a sparse checkout pattern
+     *
+     * @param pattern the pattern (blank lines and comments are ignored)
+     */
+    void add_pattern(std::string pattern);
+
+    /**
+     * @brief Adds every pattern in a file, one per line
+     *
+     * @param file the pattern file
+     * @return true if the file could be read
+     * @return false otherwise
+     */
+    bool load_patterns(const std::filesystem::path& file);
+
+    /**
+     * @brief Whether the filter selects everything
+     *
+     */
+    bool empty() const { return paths.empty() && patterns.empty(); }
+
+    /**
+     * @brief Whether a file is selected
+     *
+     * @param file the file's absolute path
+     */
+    bool matches(const std::string& file) const;
+
+    /**
+     * @brief Removes every entry of a path to hash map that is not selected
+     *
+     * @param hashes the map
+     * @return std::unordered_map<std::string, std::string> the selected
+     * entries
+     */
+    std::unordered_map<std::string, std::string> select(
+        const std::unordered_map<std::string, std::string>& hashes) const;
+
+    /**
+     * @brief The smallest set of files and directories holding every selected
+     * file, so a scan can skip the rest of the tree. Patterns narrow it to
+     * their fixed leading directories (src/foo/ to src/foo, src/*.c to src),
+     * except for patterns matching at any depth, which need the whole tree.
+     *
+     */
+    std::vector<std::filesystem::path> roots() const;
+
+    /**
+     * @brief The paths the filter is limited to, relative to the root (empty
+     * for the root itself)
+     *
+     */
+    const std::vector<std::string>& relative_paths() const { return paths; }
+
+   private:
+    struct pattern_t {
+        std::string glob;
+        bool negated;
+        bool directory_only;
+        bool anchored;
+    };
+
+    bool pattern_matches(const pattern_t& pattern,
+                         const std::string& rel_path) const;
+
+    std::filesystem::path root;
+    std::vector<std::string> paths;  // relative to root
+    std::vector<pattern_t> patterns;
+};
+}  // namespace boo
@@ -0,0 +1,72 @@
+/**
+ * @file send_file.cpp
+ * @author David Xu
+ * @brief Copies a file to a descriptor inside the kernel
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "send_file.h"
+
+#include <fcntl.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "stats.h"
+#include "trace.h"
+
+using namespace std;
+
+namespace boo {
+uintmax_t send_file(const filesystem::path& source, int out, error_code& ec) {
+    trace_span span("send_file");
+    int in = open(source.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (in < 0 || fstat(in, &st) != 0) {
+        ec = error_code(errno, system_category());
+        if (in >= 0) close(in);
+        return 0;
+    }
+    stats::count(counter_t::files_opened);
+
+    off_t offset = 0;
+    off_t size = st.st_size;
+    // EINVAL means this kind of descriptor is not supported, and the next
+    // method is tried from where the last one stopped
+    while (offset < size) {
+        ssize_t n = sendfile(out, in, &offset, size - offset);
+        if (n > 0) continue;
+        if (n < 0 && errno == EINTR) continue;
+        break;
+    }
+    while (offset < size) {
+        ssize_t n = splice(in, &offset, out, nullptr, size - offset,
+                           SPLICE_F_MORE);
+        if (n > 0) continue;
+        if (n < 0 && errno == EINTR) continue;
+        break;
+    }
+    char buffer[64 * 1024];
+    while (offset < size) {
+        ssize_t n = pread(in, buffer, sizeof(buffer), offset);
+        if (n <= 0) break;
+        ssize_t written = 0;
+        while (written < n) {
+            ssize_t w = write(out, buffer + written, n - written);
+            if (w < 0 && errno == EINTR) continue;
+            if (w <= 0) break;
+            written += w;
+        }
+        offset += written;
+        if (written < n) break;
+    }
+
+    if (offset < size) ec = error_code(errno ? errno : EIO, system_category());
+    close(in);
+    stats::count(counter_t::bytes_read, offset);
+    return offset;
+}
+}  // namespace boo
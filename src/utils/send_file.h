@@ -0,0 +1,29 @@
+/**
+ * @file send_file.h
+ * @author David Xu
+ * @brief Copies a file to a descriptor inside the kernel
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <system_error>
+
+namespace boo {
+/**
+ * @brief Writes a whole file to a descriptor without copying it through user
+ * space where possible: sendfile (files and sockets), then splice (pipes),
+ * then read and write as a last resort.
+ *
+ * @param source the file
+ * @param out the descriptor to write to (e.g. stdout)
+ * @param ec set on failure
+ * @return uintmax_t the number of bytes written
+ */
+uintmax_t send_file(const std::filesystem::path& source, int out,
+                    std::error_code& ec);
+}  // namespace boo
@@ -0,0 +1,127 @@
+/**
+ * @file stats.cpp
+ * @author David Xu
+ * @brief Performance counters and per-phase timings for a command
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "stats.h"
+
+#include <sys/resource.h>
+#include <time.h>
+
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <tuple>
+
+using namespace std;
+
+namespace boo {
+static const char* counter_names[] = {
+    "files_stated", "files_opened",  "bytes_read",   "bytes_hashed",
+    "bytes_written", "cache_hits", "cache_misses", "objects_written",
+};
+static_assert(sizeof(counter_names) / sizeof(counter_names[0]) ==
+              (int)counter_t::COUNT);
+
+static u64 wall_now_us() {
+    return chrono::duration_cast<chrono::microseconds>(
+               chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+static u64 timeval_us(const timeval& tv) {
+    return (u64)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+/* the process's user and system CPU time so far */
+static pair<u64, u64> process_cpu_us() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return {timeval_us(usage.ru_utime), timeval_us(usage.ru_stime)};
+}
+
+stats::stats()
+    : is_enabled(false),
+      command(),
+      start_us(wall_now_us()),
+      start_user_us(0),
+      start_sys_us(0) {
+    for (auto& c : counters) c = 0;
+}
+
+stats& stats::instance() {
+    static stats s;
+    return s;
+}
+
+u64 stats::get(counter_t c) const {
+    return counters[(int)c].load(memory_order_relaxed);
+}
+
+void stats::enable() {
+    lock_guard<mutex> guard(lock);
+    for (auto& c : counters) c = 0;
+    phases.clear();
+    start_us = wall_now_us();
+    tie(start_user_us, start_sys_us) = process_cpu_us();
+    is_enabled = true;
+}
+
+void stats::disable() { is_enabled = false; }
+
+u64 stats::thread_cpu_us() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (u64)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+void stats::record_phase(const string& phase, u64 wall_us, u64 cpu_us) {
+    lock_guard<mutex> guard(lock);
+    auto& p = phases[phase];
+    ++p.count;
+    p.wall_us += wall_us;
+    p.cpu_us += cpu_us;
+}
+
+string stats::to_json() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    u64 user_us = timeval_us(usage.ru_utime);
+    u64 sys_us = timeval_us(usage.ru_stime);
+
+    stringstream out;
+    out << "{\"command\":\"" << string_utils::json_escape(command) << "\""
+        << ",\"timestamp\":"
+        << chrono::duration_cast<chrono::seconds>(
+               chrono::system_clock::now().time_since_epoch())
+               .count()
+        << ",\"wall_us\":" << wall_now_us() - start_us
+        << ",\"cpu_user_us\":" << user_us - min(user_us, start_user_us)
+        << ",\"cpu_sys_us\":" << sys_us - min(sys_us, start_sys_us)
+        << ",\"process_peak_rss_kb\":" << usage.ru_maxrss
+        << ",\"counters\":{";
+    for (int i = 0; i < (int)counter_t::COUNT; ++i) {
+        if (i) out << ",";
+        out << "\"" << counter_names[i] << "\":" << get((counter_t)i);
+    }
+    out << "},\"phases\":{";
+
+    lock_guard<mutex> guard(lock);
+    bool first = true;
+    for (const auto& [name, phase] : phases) {
+        if (!first) out << ",";
+        first = false;
+        out << "\"" << string_utils::json_escape(name)
+            << "\":{\"count\":" << phase.count
+            << ",\"wall_us\":" << phase.wall_us
+            << ",\"cpu_us\":" << phase.cpu_us << "}";
+    }
+    out << "}}";
+    return out.str();
+}
+}  // namespace boo
@@ -0,0 +1,141 @@
+/**
+ * @file stats.h
+ * @author David Xu
+ * @brief Performance counters and per-phase timings for a command
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "utils.h"
+
+namespace boo {
+/**
+ * @brief the counters collected for each command
+ *
+ */
+enum class counter_t {
+    files_stated,
+    files_opened,
+    bytes_read,
+    bytes_hashed,
+    bytes_written,
+    cache_hits,
+    cache_misses,
+    objects_written,
+    COUNT
+};
+
+/**
+ * @brief aggregate timing of every span sharing a name
+ *
+ */
+struct phase_stats_t {
+    u64 count = 0;
+    u64 wall_us = 0;
+    u64 cpu_us = 0;
+};
+
+/**
+ * @brief Process wide performance counters. Counters are always collected
+ * (they are single relaxed atomic adds); phase timings are only collected
+ * once enable() has been called.
+ *
+ */
+class stats {
+   public:
+    /**
+     * @brief Gets the process wide stats collector
+     *
+     * @return stats& the collector
+     */
+    static stats& instance();
+
+    /**
+     * @brief Increments a counter
+     *
+     * @param c the counter
+     * @param amount the amount to add
+     */
+    static void count(counter_t c, u64 amount = 1) {
+        instance().counters[(int)c].fetch_add(amount,
+                                              std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Gets the current value of a counter
+     *
+     */
+    u64 get(counter_t c) const;
+
+    /**
+     * @brief Resets all counters and the CPU time baseline, and starts
+     * collecting phase timings (so each command run in a long lived process
+     * reports only its own cost)
+     *
+     */
+    void enable();
+
+    /**
+     * @brief Stops collecting phase timings
+     *
+     */
+    void disable();
+
+    /**
+     * @brief Whether phase timings are being collected
+     *
+     */
+    bool enabled() const { return is_enabled; }
+
+    /**
+     * @brief Adds a finished span to its phase's totals
+     *
+     * @param phase the span name
+     * @param wall_us wall clock duration
+     * @param cpu_us cpu time of the calling thread during the span
+     */
+    void record_phase(const std::string& phase, u64 wall_us, u64 cpu_us);
+
+    /**
+     * @brief Sets the command reported in the output
+     *
+     */
+    void set_command(std::string command) { this->command = command; }
+
+    /**
+     * @brief Serializes all counters, phases and the CPU time used since
+     * enable() as a single line JSON object. Peak RSS cannot be measured per
+     * command, so it is reported as the process's (process_peak_rss_kb).
+     *
+     * @return std::string the JSON
+     */
+    std::string to_json();
+
+    /**
+     * @brief CPU time consumed by the calling thread so far
+     *
+     * @return u64 microseconds
+     */
+    static u64 thread_cpu_us();
+
+   private:
+    stats();
+
+    std::atomic<bool> is_enabled;  // read by every thread that opens a span
+    std::string command;
+    u64 start_us;
+    u64 start_user_us;  // process CPU time when enabled
+    u64 start_sys_us;
+    std::atomic<u64> counters[(int)counter_t::COUNT];
+    std::mutex lock;
+    std::map<std::string, phase_stats_t> phases;
+};
+}  // namespace boo
@@ -0,0 +1,153 @@
+/**
+ * @file text_search.cpp
+ * @author David Xu
+ * @brief Finds the lines of a text matching a literal or regular expression
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "text_search.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+namespace boo {
+text_search::text_search(const string& pattern, bool regex)
+    : literal(regex ? required_literal(pattern) : pattern), expression() {
+    if (regex) expression.emplace(pattern, std::regex::ECMAScript);
+}
+
+size_t text_search::search(string_view text,
+                           function<bool(size_t, string_view)> visit) const {
+    const char* data = text.data();
+    size_t size = text.size();
+    size_t matches = 0;
+    size_t line = 1;
+    size_t pos = 0;  // always the start of a line
+    while (pos < size) {
+        // without a literal every line is a candidate
+        size_t hit = pos;
+        if (!literal.empty()) {
+            hit = find(text, literal, pos);
+            if (hit == string_view::npos) break;
+        }
+
+        size_t start = pos;
+        if (hit > pos) {
+            const void* newline = memrchr(data + pos, '\n', hit - pos);
+            if (newline) start = (const char*)newline - data + 1;
+        }
+        const void* newline = memchr(data + hit, '\n', size - hit);
+        size_t end = newline ? (const char*)newline - data : size;
+        line += count(data + pos, data + start, '\n');
+
+        string_view candidate(data + start, end - start);
+        if (!expression ||
+            regex_search(candidate.begin(), candidate.end(), *expression)) {
+            ++matches;
+            if (visit && !visit(line, candidate)) break;
+        }
+        if (!newline) break;
+        pos = end + 1;
+        ++line;
+    }
+    return matches;
+}
+
+size_t text_search::find(string_view haystack, string_view needle,
+                         size_t from) {
+    size_t m = needle.size();
+    size_t size = haystack.size();
+    if (m == 0) return from <= size ? from : string_view::npos;
+    if (m > size || from > size - m) return string_view::npos;
+    const char* data = haystack.data();
+    if (m == 1) {
+        const void* found = memchr(data + from, needle[0], size - from);
+        return found ? (const char*)found - data : string_view::npos;
+    }
+
+    size_t last = size - m;  // the last position a match can start at
+    size_t i = from;
+#ifdef __SSE2__
+    // candidates are positions where both the first and the last byte of the
+    // needle line up; only those are compared in full
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i final = _mm_set1_epi8(needle[m - 1]);
+    for (; i + 15 <= last; i += 16) {
+        __m128i head = _mm_loadu_si128((const __m128i*)(data + i));
+        __m128i tail = _mm_loadu_si128((const __m128i*)(data + i + m - 1));
+        unsigned mask = _mm_movemask_epi8(_mm_and_si128(
+            _mm_cmpeq_epi8(head, first), _mm_cmpeq_epi8(tail, final)));
+        while (mask) {
+            size_t at = i + __builtin_ctz(mask);
+            if (memcmp(data + at + 1, needle.data() + 1, m - 2) == 0) {
+                return at;
+            }
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for (; i <= last; ++i) {
+        if (data[i] == needle[0] && memcmp(data + i, needle.data(), m) == 0) {
+            return i;
+        }
+    }
+    return string_view::npos;
+}
+
+string text_search::required_literal(const string& pattern) {
+    if (pattern.find_first_of("|()") != string::npos) return "";
+    string best, run;
+    auto end_run = [&best, &run] {
+        if (run.size() > best.size()) best = run;
+        run.clear();
+    };
+    for (size_t i = 0; i < pattern.size(); ++i) {
+        char c = pattern[i];
+        if (c == '\\' && i + 1 < pattern.size()) {
+            char escaped = pattern[++i];
+            // \d, \w, \b, \1, \x41, ... are classes, anchors, back
+            // references or character codes; none is the text it is spelled
+            // with, and the code's digits are skipped with it
+            if (isalnum((unsigned char)escaped)) {
+                end_run();
+                size_t digits = escaped == 'x' ? 2 : escaped == 'u' ? 4 : 0;
+                if (escaped == 'c') digits = 1;
+                if (isdigit((unsigned char)escaped)) {
+                    digits = strspn(pattern.c_str() + i + 1, "0123456789");
+                }
+                i = min(i + digits, pattern.size() - 1);
+            } else {
+                run += escaped;
+            }
+        } else if (c == '*' || c == '?' || c == '{') {
+            // the character before is optional
+            if (!run.empty()) run.pop_back();
+            end_run();
+            if (c == '{') i = min(pattern.find('}', i), pattern.size());
+        } else if (c == '[') {
+            end_run();
+            // a ] right after [ or [^ is part of the set
+            size_t close = i + 1;
+            if (close < pattern.size() && pattern[close] == '^') ++close;
+            if (close < pattern.size() && pattern[close] == ']') ++close;
+            i = min(pattern.find(']', close), pattern.size());
+        } else if (strchr(".^$+", c)) {
+            end_run();
+        } else {
+            run += c;
+        }
+    }
+    end_run();
+    return best;
+}
+}  // namespace boo
@@ -0,0 +1,84 @@
+/**
+ * @file text_search.h
+ * @author David Xu
+ * @brief Finds the lines of a text matching a literal or regular expression
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <regex>
+#include <string>
+#include <string_view>
+
+namespace boo {
+/**
+ * @brief A compiled search pattern. Every match must contain a literal string
+ * (the pattern itself, or for a regular expression the longest run of plain
+ * characters it requires), which is found with an SSE2 scan comparing the
+ * first and last byte of the literal at sixteen positions at once; only the
+ * lines it appears on are handed to the regex engine. A regular expression
+ * with alternation or groups has no required literal, so every line is
+ * checked.
+ *
+ */
+class text_search {
+   public:
+    /**
+     * @brief Compiles a pattern
+     *
+     * @param pattern the pattern
+     * @param regex whether the pattern is an ECMAScript regular expression
+     * rather than a literal string
+     * @throws std::regex_error if the regular expression is malformed
+     */
+    text_search(const std::string& pattern, bool regex = false);
+
+    /**
+     * @brief Visits the lines of a text that match, in order
+     *
+     * @param text the text
+     * @param visit called with each matching line's number (from 1) and the
+     * line without its newline; stop early by returning false
+     * @return size_t the number of matching lines visited
+     */
+    size_t search(
+        std::string_view text,
+        std::function<bool(size_t, std::string_view)> visit = {}) const;
+
+    /**
+     * @brief The literal every match contains (empty if none is known)
+     *
+     */
+    const std::string& required() const { return literal; }
+
+    /**
+     * @brief Finds a string (SSE2 where available)
+     *
+     * @param haystack the text to search
+     * @param needle the string to find
+     * @param from where to start
+     * @return size_t the position of the first occurrence at or after from,
+     * or npos
+     */
+    static size_t find(std::string_view haystack, std::string_view needle,
+                       size_t from = 0);
+
+   private:
+    /**
+     * @brief The longest run of plain characters every match of a regular
+     * expression contains, or empty if there is none (or alternation or
+     * groups make it hard to tell)
+     *
+     */
+    static std::string required_literal(const std::string& pattern);
+
+    std::string literal;
+    std::optional<std::regex> expression;  // unset for literal patterns
+};
+}  // namespace boo
@@ -0,0 +1,77 @@
+/**
+ * @file thread_pool.cpp
+ * @author David Xu
+ * @brief Fixed size pool of worker threads
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+using namespace std;
+
+namespace boo {
+thread_pool::thread_pool(unsigned threads)
+    : workers(), tasks(), lock(), pending(0), stopping(false) {
+    if (!threads) threads = default_size();
+    for (unsigned i = 0; i < threads; ++i) {
+        workers.emplace_back(&thread_pool::work, this);
+    }
+}
+
+thread_pool::~thread_pool() {
+    wait();
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    task_ready.notify_all();
+    for (auto& worker : workers) worker.join();
+}
+
+unsigned thread_pool::default_size() {
+    if (const char* env = getenv("BOO_THREADS")) {
+        int threads = atoi(env);
+        if (threads > 0) return threads;
+    }
+    return max(1u, thread::hardware_concurrency());
+}
+
+void thread_pool::submit(function<void()> task) {
+    {
+        lock_guard<mutex> guard(lock);
+        tasks.push_back(std::move(task));
+        ++pending;
+    }
+    task_ready.notify_one();
+}
+
+void thread_pool::wait() {
+    unique_lock<mutex> guard(lock);
+    all_done.wait(guard, [this] { return pending == 0; });
+}
+
+void thread_pool::work() {
+    while (true) {
+        function<void()> task;
+        {
+            unique_lock<mutex> guard(lock);
+            task_ready.wait(guard,
+                            [this] { return stopping || !tasks.empty(); });
+            if (tasks.empty()) return;
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+        {
+            lock_guard<mutex> guard(lock);
+            if (--pending == 0) all_done.notify_all();
+        }
+    }
+}
+}  // namespace boo
@@ -0,0 +1,80 @@
+/**
+ * @file thread_pool.h
+ * @author David Xu
+ * @brief Fixed size pool of worker threads
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace boo {
+/**
+ * @brief Runs submitted tasks on a fixed set of worker threads. Tasks must not
+ * throw; catch inside the task and record the failure instead.
+ *
+ */
+class thread_pool {
+   public:
+    /**
+     * @brief Starts the workers
+     *
+     * @param threads the number of workers (0 for one per hardware thread)
+     */
+    thread_pool(unsigned threads = 0);
+
+    /**
+     * @brief Waits for every submitted task, then stops the workers
+     *
+     */
+    ~thread_pool();
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    /**
+     * @brief Queues a task
+     *
+     * @param task the task
+     */
+    void submit(std::function<void()> task);
+
+    /**
+     * @brief Blocks until every task submitted so far has finished
+     *
+     */
+    void wait();
+
+    /**
+     * @brief The number of workers
+     *
+     */
+    unsigned size() const { return workers.size(); }
+
+    /**
+     * @brief The default number of workers: BOO_THREADS if set, otherwise one
+     * per hardware thread
+     *
+     */
+    static unsigned default_size();
+
+   private:
+    void work();
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex lock;
+    std::condition_variable task_ready;
+    std::condition_variable all_done;
+    size_t pending;  // tasks queued or running
+    bool stopping;
+};
+}  // namespace boo
@@ -0,0 +1,137 @@
+/**
+ * @file trace.cpp
+ * @author David Xu
+ * @brief Scoped span tracing in the Chrome trace event format
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "trace.h"
+
+#include <unistd.h>
+
+#include <fstream>
+
+// per-file spans on huge trees would otherwise produce gigabytes of JSON
+#define MAX_TRACE_EVENTS (1 << 21)
+
+using namespace std;
+
+namespace boo {
+tracer::tracer()
+    : is_enabled(false),
+      output_path(),
+      epoch(chrono::steady_clock::now()),
+      dropped(0) {}
+
+tracer& tracer::instance() {
+    static tracer t;
+    return t;
+}
+
+void tracer::enable(string path) {
+    {
+        lock_guard<mutex> guard(lock);
+        output_path = path;
+        events.clear();
+        dropped = 0;
+        is_enabled = true;
+    }
+    set_thread_name("main");
+}
+
+void tracer::disable() { is_enabled = false; }
+
+u64 tracer::now_us() const {
+    return chrono::duration_cast<chrono::microseconds>(
+               chrono::steady_clock::now() - epoch)
+        .count();
+}
+
+u32 tracer::thread_index() {
+    // caller holds the lock
+    auto id = this_thread::get_id();
+    auto itr = thread_ids.find(id);
+    if (itr != thread_ids.end()) return itr->second;
+
+    u32 index = thread_ids.size() + 1;
+    thread_ids[id] = index;
+    return index;
+}
+
+void tracer::record(string name, string args, u64 start_us, u64 duration_us) {
+    if (!is_enabled) return;
+    lock_guard<mutex> guard(lock);
+    if (events.size() >= MAX_TRACE_EVENTS) {
+        ++dropped;
+        return;
+    }
+    events.push_back({std::move(name), std::move(args), start_us, duration_us,
+                      thread_index()});
+}
+
+void tracer::set_thread_name(string name) {
+    if (!is_enabled) return;
+    lock_guard<mutex> guard(lock);
+    thread_names[thread_index()] = name;
+}
+
+bool tracer::write() {
+    if (!is_enabled) return false;
+    lock_guard<mutex> guard(lock);
+
+    ofstream out(output_path, ios::trunc);
+    if (!out) return false;
+
+    const int pid = getpid();
+    out << "{\"traceEvents\":[\n";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid
+        << ",\"tid\":0,\"args\":{\"name\":\"boo\"}}";
+    for (const auto& [tid, name] : thread_names) {
+        out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid
+            << ",\"tid\":" << tid << ",\"args\":{\"name\":\""
+            << string_utils::json_escape(name) << "\"}}";
+    }
+    for (const auto& event : events) {
+        out << ",\n{\"name\":\"" << string_utils::json_escape(event.name)
+            << "\",\"cat\":\"boo\",\"ph\":\"X\",\"ts\":" << event.start_us
+            << ",\"dur\":" << event.duration_us << ",\"pid\":" << pid
+            << ",\"tid\":" << event.tid;
+        if (!event.args.empty()) out << ",\"args\":{" << event.args << "}";
+        out << "}";
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped_events\":"
+        << dropped << "}}" << endl;
+
+    return out.good();
+}
+
+trace_span::trace_span(string name) : trace_span(std::move(name), "") {}
+
+trace_span::trace_span(string name, string args)
+    : tracing(tracer::instance().enabled()),
+      timing(stats::instance().enabled()),
+      start_us(0),
+      start_cpu_us(0) {
+    if (!tracing && !timing) return;
+    this->name = std::move(name);
+    this->args = std::move(args);
+    start_us = tracer::instance().now_us();
+    if (timing) start_cpu_us = stats::thread_cpu_us();
+}
+
+trace_span::~trace_span() {
+    if (!tracing && !timing) return;
+    auto& t = tracer::instance();
+    u64 duration_us = t.now_us() - start_us;
+    if (timing) {
+        stats::instance().record_phase(name, duration_us,
+                                       stats::thread_cpu_us() - start_cpu_us);
+    }
+    if (tracing) {
+        t.record(std::move(name), std::move(args), start_us, duration_us);
+    }
+}
+}  // namespace boo
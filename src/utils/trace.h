@@ -0,0 +1,139 @@
+/**
+ * @file trace.h
+ * @author David Xu
+ * @brief Scoped span tracing in the Chrome trace event format
+ * @version 0.1
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "stats.h"
+#include "utils.h"
+
+namespace boo {
+/**
+ * @brief a single completed span
+ *
+ */
+struct trace_event_t {
+    std::string name;
+    std::string args;  // preformatted JSON object body, may be empty
+    u64 start_us;
+    u64 duration_us;
+    u32 tid;
+};
+
+/**
+ * @brief Process wide collector of trace spans. Disabled (and nearly free)
+ * unless enable() is called.
+ *
+ */
+class tracer {
+   public:
+    /**
+     * @brief Gets the process wide tracer
+     *
+     * @return tracer& the tracer
+     */
+    static tracer& instance();
+
+    /**
+     * @brief Starts recording spans, to be written to path on write(). Any
+     * previously recorded spans are discarded.
+     *
+     * @param path the output file
+     */
+    void enable(std::string path);
+
+    /**
+     * @brief Stops recording spans
+     *
+     */
+    void disable();
+
+    /**
+     * @brief Whether spans are being recorded
+     *
+     */
+    bool enabled() const { return is_enabled; }
+
+    /**
+     * @brief Microseconds since the tracer was created
+     *
+     * @return u64 the timestamp
+     */
+    u64 now_us() const;
+
+    /**
+     * @brief Records a completed span
+     *
+     * @param name the span name
+     * @param args preformatted JSON object body (e.g. "\"path\":\"a\"")
+     * @param start_us the start timestamp
+     * @param duration_us the duration
+     */
+    void record(std::string name, std::string args, u64 start_us,
+                u64 duration_us);
+
+    /**
+     * @brief Names the calling thread in the trace output
+     *
+     * @param name the thread name
+     */
+    void set_thread_name(std::string name);
+
+    /**
+     * @brief Writes all recorded spans as Chrome trace event JSON
+     *
+     * @return true if the trace was written
+     * @return false otherwise
+     */
+    bool write();
+
+   private:
+    tracer();
+    u32 thread_index();
+
+    std::atomic<bool> is_enabled;  // read by every thread that opens a span
+    std::string output_path;
+    std::chrono::steady_clock::time_point epoch;
+    std::mutex lock;
+    std::vector<trace_event_t> events;
+    u64 dropped;
+    std::unordered_map<std::thread::id, u32> thread_ids;
+    std::unordered_map<u32, std::string> thread_names;
+};
+
+/**
+ * @brief RAII span; records [construction, destruction) to the tracer and
+ * adds its duration to the phase of the same name in stats
+ *
+ */
+class trace_span {
+   public:
+    trace_span(std::string name);
+    trace_span(std::string name, std::string args);
+    ~trace_span();
+
+    trace_span(const trace_span&) = delete;
+    trace_span& operator=(const trace_span&) = delete;
+
+   private:
+    bool tracing;
+    bool timing;
+    std::string name;
+    std::string args;
+    u64 start_us;
+    u64 start_cpu_us;
+};
+}  // namespace boo
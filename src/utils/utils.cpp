@@ -9,6 +9,10 @@
  *
  */
 #include "utils.h"
+
+#include <cctype>
+#include <cstdio>
+
 namespace boo::bit_utils {
 u32 rotate_left(u32 val, u8 amount) {
     return (val << amount) | (val >> (32 - amount));
@@ -23,3 +27,85 @@ int next_multiple(const int a, const int b) {
     return ((a / b) * b + b);
 }
 }  // namespace boo::bit_utils
+
+namespace boo::string_utils {
+std::string json_escape(const std::string& s) {
+    std::string escaped;
+    escaped.reserve(s.size());
+    for (char c : s) {
+        switch (c) {
+            case '"':
+                escaped += "\\\"";
+                break;
+            case '\\':
+                escaped += "\\\\";
+                break;
+            case '\n':
+                escaped += "\\n";
+                break;
+            case '\r':
+                escaped += "\\r";
+                break;
+            case '\t':
+                escaped += "\\t";
+                break;
+            default:
+                if ((unsigned char)c < 0x20) {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    escaped += buf;
+                } else {
+                    escaped += c;
+                }
+        }
+    }
+    return escaped;
+}
+
+bool split_command_line(const std::string& line,
+                        std::vector<std::string>& args) {
+    args.clear();
+    std::string arg;
+    bool in_arg = false;
+    char quote = 0;
+    for (char c : line) {
+        if (quote) {
+            if (c == quote) {
+                quote = 0;
+            } else {
+                arg += c;
+            }
+        } else if (c == '\'' || c == '"') {
+            quote = c;
+            in_arg = true;
+        } else if (isspace((unsigned char)c)) {
+            if (in_arg) args.push_back(arg);
+            arg.clear();
+            in_arg = false;
+        } else {
+            arg += c;
+            in_arg = true;
+        }
+    }
+    if (in_arg) args.push_back(arg);
+    return !quote;
+}
+}  // namespace boo::string_utils
+
+namespace boo {
+output_capture::output_capture()
+    : out_stream(),
+      err_stream(),
+      old_out(std::cout.rdbuf(out_stream.rdbuf())),
+      old_err(std::cerr.rdbuf(err_stream.rdbuf())) {
+    ++depth;
+}
+
+output_capture::~output_capture() {
+    std::cout.flush();
+    std::cerr.flush();
+    std::cout.rdbuf(old_out);
+    std::cerr.rdbuf(old_err);
+    --depth;
+}
+}  // namespace boo
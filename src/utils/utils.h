@@ -10,7 +10,11 @@
  */
 
 #pragma once
+#include <atomic>
 #include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
 
 #define u8 u_int8_t
 #define u16 u_int16_t
@@ -26,4 +30,43 @@ u32 rotate_right(u32 val, u8 amount);
 /* gets the next multiple of b larger than a */
 int next_multiple(const int a, const int b);
 }  // namespace bit_utils
+
+namespace string_utils {
+/* escapes a string for use inside a JSON string literal */
+std::string json_escape(const std::string& s);
+/* splits a command line on whitespace, honoring single and double quotes;
+ * returns false if a quote is left open */
+bool split_command_line(const std::string& line,
+                        std::vector<std::string>& args);
+}  // namespace string_utils
+
+/**
+ * @brief Redirects cout and cerr into strings for as long as it lives (e.g. to
+ * send a command's output somewhere other than the terminal)
+ *
+ */
+class output_capture {
+   public:
+    output_capture();
+    ~output_capture();
+
+    output_capture(const output_capture&) = delete;
+    output_capture& operator=(const output_capture&) = delete;
+
+    /* what was written to cout so far */
+    std::string out() const { return out_stream.str(); }
+    /* what was written to cerr so far */
+    std::string err() const { return err_stream.str(); }
+
+    /* whether any capture is live, so output written to the descriptors
+     * directly would bypass it */
+    static bool active() { return depth > 0; }
+
+   private:
+    std::stringstream out_stream;
+    std::stringstream err_stream;
+    std::streambuf* old_out;
+    std::streambuf* old_err;
+    static inline std::atomic<int> depth{0};  // live captures
+};
 }  // namespace boo
\ No newline at end of file